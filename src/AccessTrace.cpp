@@ -0,0 +1,116 @@
+#include "AccessTrace.hpp"
+#include "TextParsing.hpp"
+
+#include <charconv>
+#include <fstream>
+#include <sstream>
+
+void AccessTrace::start() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_items.clear();
+  m_recorded.clear();
+  m_start = std::chrono::steady_clock::now();
+  m_recording = true;
+}
+
+void AccessTrace::stop() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_recording = false;
+}
+
+bool AccessTrace::isRecording() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_recording;
+}
+
+void AccessTrace::record(ResourceType type, std::string_view path) {
+  auto now = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!m_recording || !m_recorded.emplace(path).second)
+    return;
+
+  TraceItem item;
+  item.type = type;
+  item.milliseconds = static_cast<std::uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(now - m_start).count());
+  item.path = path;
+  m_items.push_back(std::move(item));
+}
+
+void AccessTrace::setBytes(std::size_t index, std::size_t bytes) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (index < m_items.size())
+    m_items[index].bytes = bytes;
+}
+
+const std::vector<TraceItem>& AccessTrace::getItems() const {
+  return m_items;
+}
+
+bool AccessTrace::saveToFile(const std::string& filePath) const {
+  std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+  if (!file)
+    return false;
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  file << "# SFMLResource access trace\n";
+  for (const TraceItem& item: m_items) {
+    file << ResourceManifest::getTypeName(item.type) << ' ' << item.milliseconds << ' ' << item.bytes << ' '
+         << item.path << '\n';
+  }
+
+  return static_cast<bool>(file);
+}
+
+bool AccessTrace::loadFromFile(const std::string& filePath) {
+  std::ifstream file(filePath, std::ios::binary);
+  if (!file) {
+    clear();
+    return false;
+  }
+
+  std::ostringstream contents;
+  contents << file.rdbuf();
+  return loadFromMemory(contents.str());
+}
+
+// Read a whole word as a number
+template<typename Number>
+static bool parseNumber(std::string_view word, Number& number) {
+  auto [last, error] = std::from_chars(word.data(), word.data() + word.size(), number);
+  return error == std::errc() && last == word.data() + word.size();
+}
+
+bool AccessTrace::loadFromMemory(std::string_view text) {
+  clear();
+
+  std::vector<TraceItem> items;
+  while (!text.empty()) {
+    std::string_view line = nextLine(text);
+    if (line.empty() || line.front() == '#')
+      continue;
+
+    TraceItem item;
+    std::string_view type = nextWord(line);
+    std::string_view milliseconds = nextWord(line);
+    std::string_view bytes = nextWord(line);
+    if (!ResourceManifest::parseType(type, item.type) || !parseNumber(milliseconds, item.milliseconds) ||
+        !parseNumber(bytes, item.bytes) || line.empty())
+      return false;
+
+    item.path = line;
+    items.push_back(std::move(item));
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_items = std::move(items);
+  for (const TraceItem& item: m_items)
+    m_recorded.insert(item.path);
+  return true;
+}
+
+void AccessTrace::clear() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_items.clear();
+  m_recorded.clear();
+  m_recording = false;
+}
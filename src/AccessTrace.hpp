@@ -0,0 +1,146 @@
+/*
+DEPENDENCIES:
+std::chrono
+std::mutex
+std::string
+std::string_view
+std::unordered_set
+std::vector
+sf::Time
+ResourceManifest
+*/
+
+#pragma once
+
+#include <SFML/System.hpp>
+
+#include "ResourceManifest.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+/*
+A record of which resources a run of the game looked up, in the order (and at the time) that each
+was first looked up. The files a game needs, and when, hardly change from one run to the next, so
+a trace saved by one run lets the next one load them in the background just before they are needed
+(see ResourceManager::startPrefetch), rather than finding out about each one at the moment of use.
+
+FORMAT (one item per line, '#' starts a comment line):
+
+  # SFMLResource access trace
+  texture 0    262144 textures/ui/title.png
+  font    12   0      fonts/title.ttf
+  sound   4310 88200  sounds/door.wav
+
+Each item is a type (as in a manifest, see ResourceManifest.hpp), the milliseconds since recording
+started, the memory the resource used once loaded (0 if it wasn't known when the trace was saved),
+and the path, which is the rest of the line. Items are in the order they were first looked up.
+*/
+
+struct TraceItem {
+  ResourceType type;
+  std::uint32_t milliseconds = 0;
+  std::size_t bytes = 0;
+  std::string path;
+};
+
+/**
+ * @brief The limits that the prefetcher stays within, see ResourceManager::startPrefetch
+ */
+struct PrefetchBudget {
+  /**
+   * @brief The most memory that prefetched resources can add up to (as recorded in the trace, or the
+   * file size when it wasn't). 0 means no limit.
+   */
+  std::size_t memoryBytes = 0;
+
+  /**
+   * @brief The most bytes of files that can be read per second, so that prefetching doesn't compete
+   * with the game's own loads. 0 means no limit.
+   */
+  std::size_t ioBytesPerSecond = 0;
+
+  /**
+   * @brief How far ahead of the time it was needed in the trace each file is loaded
+   */
+  sf::Time lookahead = sf::seconds(2);
+};
+
+class AccessTrace {
+
+public:
+  /**
+   * @brief Forget everything recorded so far, and start recording with the clock at zero
+   */
+  void start();
+
+  /**
+   * @brief Stop recording. The items recorded so far are kept.
+   */
+  void stop();
+
+  bool isRecording() const;
+
+  /**
+   * @brief Add a path to the trace, unless it is already in it. Does nothing while not recording.
+   * Safe to call from several threads at once.
+   *
+   * @param type The type of resource
+   * @param path The path it was looked up with
+   */
+  void record(ResourceType type, std::string_view path);
+
+  /**
+   * @brief Set the memory that the resource of an item used, to be saved with it
+   */
+  void setBytes(std::size_t index, std::size_t bytes);
+
+  /**
+   * @brief Get the items, in the order they were first looked up. Not to be used while recording,
+   * since other threads could be adding to them.
+   */
+  const std::vector<TraceItem>& getItems() const;
+
+  /**
+   * @brief Write the items to a file
+   *
+   * @param filePath The location of the trace
+   * @return true The trace was written
+   * @return false The file couldn't be written
+   */
+  bool saveToFile(const std::string& filePath) const;
+
+  /**
+   * @brief Read a trace file, replacing the items (and stopping recording)
+   *
+   * @param filePath The location of the trace
+   * @return true The trace was read
+   * @return false The file couldn't be read, or has an invalid line; no items are kept
+   */
+  bool loadFromFile(const std::string& filePath);
+
+  /**
+   * @brief Read a trace from text in memory, as with loadFromFile
+   */
+  bool loadFromMemory(std::string_view text);
+
+  void clear();
+
+private:
+  mutable std::mutex m_mutex;
+  bool m_recording = false;
+  std::chrono::steady_clock::time_point m_start;
+
+  std::vector<TraceItem> m_items;
+
+  /**
+   * @brief The paths in m_items, so that each is only recorded once
+   */
+  std::unordered_set<std::string> m_recorded;
+};
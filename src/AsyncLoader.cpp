@@ -0,0 +1,63 @@
+#include "AsyncLoader.hpp"
+
+AsyncLoader::~AsyncLoader() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+    m_jobs.clear();
+  }
+  m_condition.notify_all();
+
+  if (m_thread.joinable())
+    m_thread.join();
+}
+
+void AsyncLoader::push(Job job) {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_jobs.push_back(std::move(job));
+
+    // We only start the thread once something actually needs to be loaded
+    if (!m_thread.joinable())
+      m_thread = std::thread(&AsyncLoader::run, this);
+  }
+  m_condition.notify_one();
+}
+
+bool AsyncLoader::popFinished(std::function<void()>& finalizer) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_finished.empty())
+    return false;
+
+  finalizer = std::move(m_finished.front());
+  m_finished.pop_front();
+  return true;
+}
+
+std::size_t AsyncLoader::getNumberOfPendingJobs() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_jobs.size() + m_running + m_finished.size();
+}
+
+void AsyncLoader::run() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  while (true) {
+    m_condition.wait(lock, [this]() { return m_stopping || !m_jobs.empty(); });
+    if (m_stopping)
+      return;
+
+    Job job = std::move(m_jobs.front());
+    m_jobs.pop_front();
+    m_running++;
+
+    // The actual loading is done without holding the lock, so the main thread
+    // can keep pushing and collecting jobs
+    lock.unlock();
+    std::function<void()> finalizer = job();
+    lock.lock();
+
+    m_running--;
+    m_finished.push_back(std::move(finalizer));
+  }
+}
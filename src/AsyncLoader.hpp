@@ -0,0 +1,90 @@
+/*
+DEPENDENCIES:
+std::thread
+std::mutex
+std::condition_variable
+std::deque
+std::function
+*/
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/*
+A small background job queue used by ResourceManager for non blocking requests.
+
+Each job is run on the background thread, and returns a second function (the finalizer)
+which is queued up until the owning thread collects it through popFinished(). This is
+so that anything that has to happen on the main thread (like uploading a texture to the
+graphics card) can be split from the slow part (reading and decoding the file).
+*/
+
+class AsyncLoader {
+
+public:
+  /**
+   * @brief The work done on the background thread. Returns the function that should later be
+   * run on the owning thread to finish the job.
+   */
+  typedef std::function<std::function<void()>()> Job;
+
+  AsyncLoader() = default;
+  AsyncLoader(const AsyncLoader&) = delete;
+  AsyncLoader& operator=(const AsyncLoader&) = delete;
+
+  /**
+   * @brief Stops the background thread once it finishes the job it is currently working on.
+   * Any jobs that haven't been started yet are thrown away.
+   */
+  ~AsyncLoader();
+
+  /**
+   * @brief Add a job to the back of the queue. The background thread is started the first time
+   * this is called.
+   * 
+   * @param job The job to run in the background
+   */
+  void push(Job job);
+
+  /**
+   * @brief Take the finalizer of the oldest finished job, if there is one.
+   * 
+   * @param finalizer Will be set to the finalizer if one was available
+   * @return true A finished job was available
+   * @return false No jobs have finished
+   */
+  bool popFinished(std::function<void()>& finalizer);
+
+  /**
+   * @brief Get the number of jobs that have been pushed but whose finalizers haven't been collected yet.
+   * 
+   * @return std::size_t The number of outstanding jobs
+   */
+  std::size_t getNumberOfPendingJobs();
+
+private:
+  /**
+   * @brief The loop run by the background thread
+   */
+  void run();
+
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+
+  std::deque<Job> m_jobs;
+  std::deque<std::function<void()>> m_finished;
+
+  /**
+   * @brief The number of jobs taken off of m_jobs that haven't been added to m_finished yet
+   */
+  std::size_t m_running = 0;
+
+  bool m_stopping = false;
+  std::thread m_thread;
+};
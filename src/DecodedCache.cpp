@@ -0,0 +1,125 @@
+#include "DecodedCache.hpp"
+#include "Hash.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+
+bool DecodedCache::open(const std::string& directory) {
+  std::error_code error;
+  std::filesystem::create_directories(directory, error);
+  if (error || !std::filesystem::is_directory(directory, error))
+    return false;
+
+  m_directory = directory;
+  return true;
+}
+
+void DecodedCache::close() {
+  m_directory.clear();
+}
+
+bool DecodedCache::isOpen() const {
+  return !m_directory.empty();
+}
+
+bool DecodedCache::read(const std::string& sourcePath, const Stamp& stamp, MappedFile& file, const void*& data,
+                        std::size_t& size, std::uint32_t variant) const {
+  if (!isOpen() || !stamp.valid)
+    return false;
+
+  if (!file.open(getEntryPath(sourcePath, variant)) || file.getSize() < sizeof(Header))
+    return false;
+
+  Header header;
+  std::memcpy(&header, file.getData(), sizeof(header));
+
+  // The entry is only good if it is for this exact file, and the file hasn't changed since
+  if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION ||
+      header.sourceSize != stamp.size || header.sourceTime != stamp.time ||
+      sizeof(Header) + header.pathLength > header.dataOffset ||
+      header.dataOffset + header.dataSize > file.getSize() ||
+      std::string_view(reinterpret_cast<const char*>(file.getData()) + sizeof(Header), header.pathLength) != sourcePath) {
+    file.close();
+    return false;
+  }
+
+  data = file.getData() + header.dataOffset;
+  size = static_cast<std::size_t>(header.dataSize);
+  return true;
+}
+
+bool DecodedCache::write(const std::string& sourcePath, const Stamp& stamp, const std::vector<char>& data,
+                         std::uint32_t variant) const {
+  if (!isOpen() || !stamp.valid)
+    return false;
+
+  Header header;
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  header.sourceSize = stamp.size;
+  header.sourceTime = stamp.time;
+
+  // The data is aligned so that it can be read as pixels or samples straight from the mapping
+  header.pathLength = static_cast<std::uint32_t>(sourcePath.size());
+  header.dataOffset = static_cast<std::uint32_t>((sizeof(Header) + sourcePath.size() + 15) / 16 * 16);
+  header.dataSize = data.size();
+
+  // Each write goes to its own temporary file, which is then moved over the old entry
+  static std::atomic<unsigned int> counter(0);
+  std::string entryPath = getEntryPath(sourcePath, variant);
+  std::string tempPath = entryPath + "." + std::to_string(counter++) + ".tmp";
+
+  {
+    std::ofstream entry(tempPath, std::ios::binary | std::ios::trunc);
+    if (!entry)
+      return false;
+
+    const char padding[16] = {};
+    entry.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    entry.write(sourcePath.data(), sourcePath.size());
+    entry.write(padding, header.dataOffset - sizeof(header) - sourcePath.size());
+    entry.write(data.data(), data.size());
+
+    if (!entry) {
+      entry.close();
+      std::remove(tempPath.c_str());
+      return false;
+    }
+  }
+
+  std::error_code error;
+  std::filesystem::rename(tempPath, entryPath, error);
+  if (error) {
+    std::remove(tempPath.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+DecodedCache::Stamp DecodedCache::getStamp(const std::string& sourcePath) {
+  Stamp stamp;
+  std::error_code error;
+  stamp.size = std::filesystem::file_size(sourcePath, error);
+  if (error)
+    return stamp;
+
+  stamp.time = std::filesystem::last_write_time(sourcePath, error).time_since_epoch().count();
+  stamp.valid = !error;
+  return stamp;
+}
+
+std::string DecodedCache::getEntryPath(const std::string& sourcePath, std::uint32_t variant) const {
+  // The default variant keeps the plain name, so existing entries stay valid
+  char name[48];
+  unsigned long long hash = static_cast<unsigned long long>(hashString(sourcePath));
+  if (variant == 0)
+    std::snprintf(name, sizeof(name), "%016llx.bin", hash);
+  else
+    std::snprintf(name, sizeof(name), "%016llx-%u.bin", hash, static_cast<unsigned int>(variant));
+  return (std::filesystem::path(m_directory) / name).string();
+}
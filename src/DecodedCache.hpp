@@ -0,0 +1,124 @@
+/*
+DEPENDENCIES:
+std::filesystem
+MappedFile
+*/
+
+#pragma once
+
+#include "MappedFile.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+An on disk cache of already decoded resources (raw RGBA pixels, PCM samples), so that files
+that haven't changed since the last run don't have to go through the PNG/WAV decoders again.
+
+Each source file gets its own entry file in the cache directory, named after the hash of its
+path. The entry records the path, size and modification time of the source, and is only used
+while those still match; otherwise the source is decoded again and the entry is rewritten, so
+stale entries are rebuilt one file at a time as they are loaded. Entries are written to a
+temporary file and renamed into place, so a crash never leaves a half written entry behind.
+
+The stamp (size and modification time) of a source is taken by the caller before it reads the
+file, and the same stamp is written with the entry; a file that changes while it is being decoded
+then leaves an entry with the old stamp, which is rebuilt on the next load.
+
+What goes in an entry is up to the loader (see Loader::serialize/deserialize in ResourceLoaders.hpp).
+A loader with variants (eg. texture resolution tiers) stores one entry per variant of a file.
+*/
+
+class DecodedCache {
+
+public:
+  /**
+   * @brief The size and modification time of a source file
+   */
+  struct Stamp {
+    std::uint64_t size = 0;
+    std::int64_t time = 0;
+
+    /**
+     * @brief Whether the file could be looked at; an entry is never read or written otherwise
+     */
+    bool valid = false;
+  };
+
+  /**
+   * @brief Get the stamp of a source file, see Stamp
+   */
+  static Stamp getStamp(const std::string& sourcePath);
+
+  /**
+   * @brief Use the given directory for the cache, creating it if need be
+   * 
+   * @param directory The directory the entries are stored in
+   * @return true The directory exists and can be used
+   * @return false The directory couldn't be created
+   */
+  bool open(const std::string& directory);
+
+  /**
+   * @brief Stop using the cache directory. The entries are left on disk.
+   */
+  void close();
+
+  /**
+   * @brief Whether a cache directory is in use
+   */
+  bool isOpen() const;
+
+  /**
+   * @brief Map the cached data for a source file, if there is an entry for it and the source hasn't
+   * changed since it was written. Safe to call from several threads at once.
+   * 
+   * @param sourcePath The file the entry was made from
+   * @param stamp The stamp of the source file, see getStamp
+   * @param file The mapping of the entry, which has to stay open while data is used
+   * @param data Will be set to the start of the cached data
+   * @param size Will be set to the size of the cached data
+   * @param variant Which variant of the decoded file to read
+   * @return true A fresh entry was found
+   * @return false There is no entry, or it is stale
+   */
+  bool read(const std::string& sourcePath, const Stamp& stamp, MappedFile& file, const void*& data,
+            std::size_t& size, std::uint32_t variant = 0) const;
+
+  /**
+   * @brief Write (or replace) the entry for a source file. Safe to call from several threads at
+   * once, as long as they are writing entries for different files.
+   * 
+   * @param sourcePath The file the data was decoded from
+   * @param stamp The stamp of the source file, taken before it was read for decoding
+   * @param data The data to store
+   * @param variant Which variant of the decoded file the data is
+   * @return true The entry was written
+   * @return false The source or entry file couldn't be accessed
+   */
+  bool write(const std::string& sourcePath, const Stamp& stamp, const std::vector<char>& data,
+             std::uint32_t variant = 0) const;
+
+private:
+  struct Header {
+    char magic[4];
+    std::uint32_t version;
+    std::uint64_t sourceSize;
+    std::int64_t sourceTime;
+    std::uint32_t pathLength;
+    std::uint32_t dataOffset;
+    std::uint64_t dataSize;
+  };
+
+  static constexpr char MAGIC[4] = {'S', 'F', 'D', 'C'};
+  static constexpr std::uint32_t VERSION = 1;
+
+  /**
+   * @brief Get the location of the entry file for a variant of a source file
+   */
+  std::string getEntryPath(const std::string& sourcePath, std::uint32_t variant) const;
+
+  std::string m_directory;
+};
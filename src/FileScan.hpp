@@ -0,0 +1,129 @@
+/*
+DEPENDENCIES:
+std::filesystem
+std::string_view
+ResourcePack
+*/
+
+#pragma once
+
+#include "ResourcePack.hpp"
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+/*
+Walking a folder (or the part of a pack under it) for the files that pre loading picks up, and
+matching their extensions against the loaders' EXTENSIONS.
+
+Extensions are compared case insensitively (so "PNG" and "Jpeg" match), with or without their
+leading dot, straight out of the path's own storage, so classifying a file never allocates. The
+walk hands each file to a callback, so that several types of files can be sorted out in a single
+pass (see ResourceManager::preLoadAll).
+*/
+
+/**
+ * @brief Whether an extension is one of the given candidates, ignoring case and leading dots
+ *
+ * @param extension The extension, eg. from std::filesystem::path::extension()
+ * @param candidates The extensions to look for, eg. Loader::EXTENSIONS
+ */
+template<typename Char, std::size_t N>
+bool matchesExtension(std::basic_string_view<Char> extension, const std::string_view (&candidates)[N]) {
+  if (!extension.empty() && extension.front() == Char('.'))
+    extension.remove_prefix(1);
+
+  for (std::string_view candidate: candidates) {
+    if (!candidate.empty() && candidate.front() == '.')
+      candidate.remove_prefix(1);
+
+    if (candidate.size() != extension.size())
+      continue;
+
+    std::size_t i = 0;
+    for (; i < candidate.size(); i++) {
+      // Only ASCII letters are folded; anything else has to match exactly
+      Char c = extension[i];
+      if (c >= Char('A') && c <= Char('Z'))
+        c = c - Char('A') + Char('a');
+
+      char expected = candidate[i];
+      if (expected >= 'A' && expected <= 'Z')
+        expected = expected - 'A' + 'a';
+
+      if (c != Char(static_cast<unsigned char>(expected)))
+        break;
+    }
+
+    if (i == candidate.size())
+      return true;
+  }
+
+  return false;
+}
+
+template<std::size_t N>
+bool matchesExtension(const std::filesystem::path& extension, const std::string_view (&candidates)[N]) {
+  const std::filesystem::path::string_type& native = extension.native();
+  return matchesExtension(std::basic_string_view<std::filesystem::path::value_type>(native), candidates);
+}
+
+/**
+ * @brief The extension of a path in a pack (which always uses '/'), including the dot, or an empty view
+ */
+inline std::string_view getPackedExtension(std::string_view path) {
+  std::size_t dot = path.rfind('.');
+  if (dot == std::string_view::npos || path.find('/', dot) != std::string_view::npos || dot == 0 || path[dot - 1] == '/')
+    return std::string_view();
+  return path.substr(dot);
+}
+
+/**
+ * @brief Call visit(path) for every regular file in a folder, and below it if recursing. The
+ * path is the folder joined with the file's name, as std::filesystem::path. Folders that can't
+ * be read are skipped rather than throwing.
+ */
+template<typename Visit>
+void scanFiles(const std::string& folderPath, bool recurse, Visit&& visit) {
+  std::error_code error;
+
+  if (recurse) {
+    auto options = std::filesystem::directory_options::skip_permission_denied;
+    std::filesystem::recursive_directory_iterator it(folderPath, options, error), end;
+    for (; !error && it != end; it.increment(error)) {
+      if (it->is_regular_file(error))
+        visit(it->path());
+    }
+  } else {
+    std::filesystem::directory_iterator it(folderPath, error), end;
+    for (; !error && it != end; it.increment(error)) {
+      if (it->is_regular_file(error))
+        visit(it->path());
+    }
+  }
+}
+
+/**
+ * @brief Call visit(path) for every file in a pack that is in a folder, and below it if recursing
+ */
+template<typename Visit>
+void scanPackedFiles(const ResourcePack& pack, const std::string& folderPath, bool recurse, Visit&& visit) {
+  std::string prefix = std::filesystem::path(folderPath).generic_string();
+  if (!prefix.empty() && prefix.back() != '/')
+    prefix += '/';
+
+  for (std::size_t i = 0; i < pack.getNumberOfEntries(); i++) {
+    std::string_view path = pack.getPath(i);
+    if (path.substr(0, prefix.size()) != prefix)
+      continue;
+
+    std::string_view name = path.substr(prefix.size());
+    if (!recurse && name.find('/') != std::string_view::npos)
+      continue;
+
+    visit(path);
+  }
+}
@@ -0,0 +1,125 @@
+#include "FileWatcher.hpp"
+
+#include <filesystem>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+FileWatcher::~FileWatcher() {
+  close();
+}
+
+bool FileWatcher::open() {
+  close();
+
+#ifdef __linux__
+  m_descriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+
+  return m_descriptor >= 0;
+}
+
+void FileWatcher::close() {
+#ifdef __linux__
+  // Closing the descriptor removes all of its watches as well
+  if (m_descriptor >= 0)
+    ::close(m_descriptor);
+#endif
+
+  m_descriptor = -1;
+  m_folders.clear();
+  m_changed.clear();
+}
+
+bool FileWatcher::isOpen() const {
+  return m_descriptor >= 0;
+}
+
+bool FileWatcher::watch(const std::string& folderPath, bool recurse) {
+  if (!addWatch(folderPath, recurse))
+    return false;
+
+  // Stepped with error codes (as in scanFiles), so that a folder that can't be read is skipped
+  // rather than throwing
+  if (recurse) {
+    std::error_code error;
+    auto options = std::filesystem::directory_options::skip_permission_denied;
+    std::filesystem::recursive_directory_iterator it(folderPath, options, error), end;
+    for (; !error && it != end; it.increment(error)) {
+      if (it->is_directory(error))
+        addWatch(it->path().string(), true);
+    }
+  }
+
+  return true;
+}
+
+bool FileWatcher::addWatch(const std::string& folderPath, bool recurse) {
+#ifdef __linux__
+  if (m_descriptor < 0)
+    return false;
+
+  // Files are only reported once they have been closed after writing (or moved into place), so
+  // a half written file is never picked up
+  int watch = inotify_add_watch(m_descriptor, folderPath.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+  if (watch < 0)
+    return false;
+
+  m_folders[watch] = Folder{folderPath, recurse};
+  return true;
+#else
+  (void) folderPath;
+  (void) recurse;
+  return false;
+#endif
+}
+
+std::vector<std::string> FileWatcher::poll(Clock::duration settleDelay) {
+  std::vector<std::string> settled;
+  if (m_descriptor < 0)
+    return settled;
+
+  Clock::time_point now = Clock::now();
+
+#ifdef __linux__
+  alignas(inotify_event) char buffer[4096];
+  ssize_t length;
+  while ((length = read(m_descriptor, buffer, sizeof(buffer))) > 0) {
+    for (char* position = buffer; position < buffer + length;) {
+      const inotify_event* event = reinterpret_cast<const inotify_event*>(position);
+      position += sizeof(inotify_event) + event->len;
+
+      auto folder = m_folders.find(event->wd);
+      if (folder == m_folders.end() || event->len == 0)
+        continue;
+
+      std::string path = (std::filesystem::path(folder->second.path) / event->name).string();
+
+      // A new folder below a recursive watch is watched too; its files will show up as their own events
+      if (event->mask & IN_ISDIR) {
+        if (folder->second.recurse && (event->mask & (IN_CREATE | IN_MOVED_TO)))
+          watch(path, true);
+        continue;
+      }
+
+      // Creating a file is always followed by closing it, which is the event that counts
+      if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+        m_changed[path] = now;
+    }
+  }
+#endif
+
+  for (auto it = m_changed.begin(); it != m_changed.end();) {
+    if (now - it->second < settleDelay) {
+      it++;
+      continue;
+    }
+
+    settled.push_back(it->first);
+    it = m_changed.erase(it);
+  }
+
+  return settled;
+}
@@ -0,0 +1,97 @@
+/*
+DEPENDENCIES:
+inotify (Linux)
+std::chrono
+std::filesystem
+std::unordered_map
+*/
+
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+Watches folders for files that have been written to, so that ResourceManager can reload
+just the files that changed. Built on inotify, so it is only available on Linux; elsewhere
+open() fails and nothing is ever reported.
+
+Editors and exporters tend to write a file in several goes (or write a lot of files at
+once), so changes aren't reported straight away. Every event for a file pushes its time
+forward, and the file is only reported once it has been quiet for the settle delay, which
+collapses a burst of events into a single reload per file.
+
+Nothing here blocks; poll() reads whatever events are waiting and returns.
+*/
+
+class FileWatcher {
+
+public:
+  typedef std::chrono::steady_clock Clock;
+
+  FileWatcher() = default;
+  FileWatcher(const FileWatcher&) = delete;
+  FileWatcher& operator=(const FileWatcher&) = delete;
+
+  ~FileWatcher();
+
+  /**
+   * @brief Start watching. Folders have to be added with watch() afterwards.
+   *
+   * @return true Watching is available
+   * @return false This isn't Linux, or inotify couldn't be initialized
+   */
+  bool open();
+
+  /**
+   * @brief Stop watching every folder and forget any changes that haven't been reported
+   */
+  void close();
+
+  bool isOpen() const;
+
+  /**
+   * @brief Watch a folder for files being written or moved into it
+   *
+   * @param folderPath The folder to watch. Reported paths start with this, in the same form
+   * as the paths found by std::filesystem::directory_iterator.
+   * @param recurse Whether to also watch every folder below it (including ones created later)
+   * @return true The folder is being watched
+   * @return false The watcher isn't open, or the folder couldn't be watched
+   */
+  bool watch(const std::string& folderPath, bool recurse);
+
+  /**
+   * @brief Read the events that have arrived since the last call, and collect the files that
+   * have been quiet for at least the settle delay.
+   *
+   * @param settleDelay How long a file has to go without another event before it is reported
+   * @return std::vector<std::string> The paths of the changed files, each reported once
+   */
+  std::vector<std::string> poll(Clock::duration settleDelay);
+
+private:
+  struct Folder {
+    std::string path;
+    bool recurse;
+  };
+
+  /**
+   * @brief Add a single inotify watch, without recursing
+   */
+  bool addWatch(const std::string& folderPath, bool recurse);
+
+  int m_descriptor = -1;
+
+  /**
+   * @brief The folder of each watch descriptor
+   */
+  std::unordered_map<int, Folder> m_folders;
+
+  /**
+   * @brief The files that have changed but haven't been reported yet, with the time of their latest event
+   */
+  std::unordered_map<std::string, Clock::time_point> m_changed;
+};
@@ -0,0 +1,73 @@
+#include "GlyphWarmup.hpp"
+
+#include <algorithm>
+
+std::u32string getAsciiCodepoints() {
+  std::u32string codepoints;
+  for (char32_t c = U' '; c <= U'~'; c++)
+    codepoints += c;
+  return codepoints;
+}
+
+std::u32string getCodepoints(std::string_view text) {
+  std::u32string codepoints;
+
+  std::size_t i = 0;
+  while (i < text.size()) {
+    unsigned char lead = static_cast<unsigned char>(text[i]);
+
+    // The number of continuation bytes, and the bits of the lead byte that belong to the character
+    std::size_t length;
+    char32_t codepoint;
+    if (lead < 0x80) {
+      length = 0;
+      codepoint = lead;
+    } else if ((lead & 0xE0) == 0xC0) {
+      length = 1;
+      codepoint = lead & 0x1F;
+    } else if ((lead & 0xF0) == 0xE0) {
+      length = 2;
+      codepoint = lead & 0x0F;
+    } else if ((lead & 0xF8) == 0xF0) {
+      length = 3;
+      codepoint = lead & 0x07;
+    } else {
+      i++;
+      continue;
+    }
+
+    std::size_t end = i + 1;
+    while (end < text.size() && end <= i + length && (static_cast<unsigned char>(text[end]) & 0xC0) == 0x80)
+      codepoint = (codepoint << 6) | (static_cast<unsigned char>(text[end++]) & 0x3F);
+
+    // A truncated sequence is skipped along with its lead byte
+    if (end == i + length + 1 && codepoints.find(codepoint) == std::u32string::npos)
+      codepoints += codepoint;
+    i = end;
+  }
+
+  return codepoints;
+}
+
+std::size_t warmGlyphs(const sf::Font& font, const GlyphWarmup& warmup) {
+  for (unsigned int characterSize: warmup.characterSizes) {
+    for (char32_t codepoint: warmup.codepoints)
+      font.getGlyph(codepoint, characterSize, warmup.bold, warmup.outlineThickness);
+  }
+
+  return getGlyphPageBytes(font, warmup.characterSizes);
+}
+
+std::size_t getGlyphPageBytes(const sf::Font& font, const std::vector<unsigned int>& characterSizes) {
+  // A size that is listed twice still only has one page
+  std::vector<unsigned int> sizes = characterSizes;
+  std::sort(sizes.begin(), sizes.end());
+  sizes.erase(std::unique(sizes.begin(), sizes.end()), sizes.end());
+
+  std::size_t bytes = 0;
+  for (unsigned int characterSize: sizes) {
+    sf::Vector2u size = font.getTexture(characterSize).getSize();
+    bytes += static_cast<std::size_t>(size.x) * size.y * 4;
+  }
+  return bytes;
+}
@@ -0,0 +1,81 @@
+/*
+DEPENDENCIES:
+sf::Font
+std::string_view
+std::u32string
+std::vector
+*/
+
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+An sf::Font only opens its file when it is loaded. Each glyph is rasterized (and copied into the
+font's glyph page texture for its character size) the first time it is drawn, so the first frame
+that shows a new piece of text, or text at a new size, pays for all of its glyphs at once.
+Warming a font rasterizes a set of glyphs up front instead, eg. during a loading screen.
+
+The glyph pages are textures, so warming has to be done on the thread that owns the GL context,
+like the rest of the texture uploads.
+*/
+
+/**
+ * @brief The glyphs to rasterize when warming a font
+ */
+struct GlyphWarmup {
+  std::vector<unsigned int> characterSizes;
+
+  /**
+   * @brief The characters, eg. getAsciiCodepoints() or getCodepoints("...") of an alphabet
+   */
+  std::u32string codepoints;
+
+  bool bold = false;
+  float outlineThickness = 0;
+
+  /**
+   * @brief Whether there is nothing to warm
+   */
+  bool isEmpty() const {
+    return characterSizes.empty() || codepoints.empty();
+  }
+};
+
+/**
+ * @brief The printable ASCII characters (space to '~')
+ */
+std::u32string getAsciiCodepoints();
+
+/**
+ * @brief The distinct characters of some UTF-8 text, in the order they first appear; eg. a
+ * localized alphabet, or all of the strings of a dialog. Invalid bytes are skipped.
+ *
+ * @param text The UTF-8 text
+ * @return std::u32string Each character once
+ */
+std::u32string getCodepoints(std::string_view text);
+
+/**
+ * @brief Rasterize the glyphs of a font for every size in the warmup
+ *
+ * @param font The font
+ * @param warmup The sizes and characters to rasterize
+ * @return std::size_t The memory held by the font's glyph pages for those sizes afterwards, in bytes
+ */
+std::size_t warmGlyphs(const sf::Font& font, const GlyphWarmup& warmup);
+
+/**
+ * @brief Get the memory held by the glyph pages of a font for the given sizes. Note that SFML
+ * creates an (empty) page for a size the first time it is asked about.
+ *
+ * @param font The font
+ * @param characterSizes The sizes
+ * @return std::size_t The size of the page textures, at 4 bytes per pixel
+ */
+std::size_t getGlyphPageBytes(const sf::Font& font, const std::vector<unsigned int>& characterSizes);
@@ -0,0 +1,85 @@
+/*
+DEPENDENCIES:
+std::string_view
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+/*
+Hash functions whose values are stable across platforms, compilers and runs (unlike
+std::hash), so they can be written to files.
+*/
+
+/**
+ * @brief 64 bit FNV-1a hash of a string. This is constexpr so it can also be used on string
+ * literals at compile time.
+ * 
+ * @param str The string to hash
+ * @return std::uint64_t The hash value
+ */
+constexpr std::uint64_t hashString(std::string_view str) {
+  std::uint64_t hash = 14695981039346656037ull;
+  for (char c: str) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+/**
+ * @brief Fast 64 bit hash of a block of memory (a single lane MurmurHash3 style mix, 8 bytes at
+ * a time). Used for comparing file contents, so it isn't meant to be cryptographically secure.
+ * 
+ * @param data The start of the memory
+ * @param size The number of bytes to hash
+ * @return std::uint64_t The hash value
+ */
+inline std::uint64_t hashBytes(const void* data, std::size_t size) {
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  const std::uint64_t multiplier1 = 0x87c37b91114253d5ull;
+  const std::uint64_t multiplier2 = 0x4cf5ad432745937full;
+
+  std::uint64_t hash = 0x9e3779b97f4a7c15ull ^ (size * multiplier1);
+
+  auto rotate = [](std::uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+  };
+
+  while (size >= 8) {
+    std::uint64_t block;
+    std::memcpy(&block, bytes, 8);
+
+    block *= multiplier1;
+    block = rotate(block, 31);
+    block *= multiplier2;
+
+    hash ^= block;
+    hash = rotate(hash, 27) * 5 + 0x52dce729;
+
+    bytes += 8;
+    size -= 8;
+  }
+
+  // Whatever is left over is mixed in as one last (partial) block
+  std::uint64_t tail = 0;
+  for (std::size_t i = 0; i < size; i++)
+    tail |= static_cast<std::uint64_t>(bytes[i]) << (8 * i);
+  tail *= multiplier1;
+  tail = rotate(tail, 31);
+  tail *= multiplier2;
+  hash ^= tail;
+
+  // The final mix spreads every input bit over the whole result
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdull;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ull;
+  hash ^= hash >> 33;
+
+  return hash;
+}
@@ -0,0 +1,100 @@
+#include "MappedFile.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+  close();
+}
+
+bool MappedFile::open(const std::string& filePath) {
+  close();
+
+#ifdef _WIN32
+  m_file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                       FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (m_file == INVALID_HANDLE_VALUE) {
+    m_file = nullptr;
+    return false;
+  }
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0) {
+    close();
+    return false;
+  }
+
+  m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!m_mapping) {
+    close();
+    return false;
+  }
+
+  m_data = static_cast<const unsigned char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+  if (!m_data) {
+    close();
+    return false;
+  }
+  m_size = static_cast<std::size_t>(size.QuadPart);
+#else
+  int file = ::open(filePath.c_str(), O_RDONLY);
+  if (file < 0)
+    return false;
+
+  struct stat info;
+  if (fstat(file, &info) != 0 || info.st_size == 0) {
+    ::close(file);
+    return false;
+  }
+
+  // The mapping stays valid after the file is closed, so we only need the one descriptor
+  void* mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+  ::close(file);
+
+  if (mapping == MAP_FAILED)
+    return false;
+
+  m_data = static_cast<const unsigned char*>(mapping);
+  m_size = static_cast<std::size_t>(info.st_size);
+#endif
+
+  return true;
+}
+
+void MappedFile::close() {
+#ifdef _WIN32
+  if (m_data)
+    UnmapViewOfFile(m_data);
+  if (m_mapping)
+    CloseHandle(m_mapping);
+  if (m_file)
+    CloseHandle(m_file);
+
+  m_mapping = nullptr;
+  m_file = nullptr;
+#else
+  if (m_data)
+    munmap(const_cast<unsigned char*>(m_data), m_size);
+#endif
+
+  m_data = nullptr;
+  m_size = 0;
+}
+
+bool MappedFile::isOpen() const {
+  return m_data != nullptr;
+}
+
+const unsigned char* MappedFile::getData() const {
+  return m_data;
+}
+
+std::size_t MappedFile::getSize() const {
+  return m_size;
+}
@@ -0,0 +1,62 @@
+/*
+DEPENDENCIES:
+mmap (POSIX) / MapViewOfFile (Windows)
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/*
+A read only memory mapping of a whole file. Used by ResourcePack and DecodedCache so that
+file contents can be handed to SFML without being read into a buffer first.
+*/
+
+class MappedFile {
+
+public:
+  MappedFile() = default;
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  ~MappedFile();
+
+  /**
+   * @brief Map a file into memory, unmapping any previous file
+   * 
+   * @param filePath The file to map
+   * @return true The file was mapped
+   * @return false The file couldn't be opened, is empty, or couldn't be mapped
+   */
+  bool open(const std::string& filePath);
+
+  /**
+   * @brief Unmap the file. The data pointer becomes invalid.
+   */
+  void close();
+
+  /**
+   * @brief Whether a file is currently mapped
+   */
+  bool isOpen() const;
+
+  /**
+   * @brief Get the start of the mapped file contents
+   */
+  const unsigned char* getData() const;
+
+  /**
+   * @brief Get the size of the mapped file
+   */
+  std::size_t getSize() const;
+
+private:
+  const unsigned char* m_data = nullptr;
+  std::size_t m_size = 0;
+
+#ifdef _WIN32
+  void* m_file = nullptr;
+  void* m_mapping = nullptr;
+#endif
+};
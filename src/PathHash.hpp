@@ -0,0 +1,28 @@
+/*
+DEPENDENCIES:
+std::hash
+std::string_view
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string_view>
+
+/*
+The hash used by every map keyed by file path (the caches, bundles and the texture atlas).
+Paired with std::equal_to<>, it lets those maps be searched with a std::string_view.
+*/
+
+/**
+ * @brief A transparent hash for the path keys, so that a lookup with a std::string_view
+ * (or a string literal) can be hashed and compared without building a std::string first.
+ */
+struct PathHash {
+  using is_transparent = void;
+
+  std::size_t operator()(std::string_view path) const {
+    return std::hash<std::string_view>{}(path);
+  }
+};
@@ -0,0 +1,82 @@
+/*
+DEPENDENCIES:
+std::shared_mutex
+std::atomic
+*/
+
+#pragma once
+
+#include <atomic>
+#include <shared_mutex>
+
+/*
+A reader/writer lock for data that is read far more often than it is written (like a cache
+that is mostly hit). A plain std::shared_mutex keeps its reader count in a single word, so
+every reader on every core writes to the same cache line, and reads stop scaling after a few
+threads. Here the lock is split into slots, one per group of threads, each on its own cache
+line: a reader only (shared) locks the slot of its own thread, so readers on different slots
+don't touch each other at all, while a writer has to lock every slot. With more threads than
+slots, the readers that share a slot still read at the same time.
+
+The slot of a thread is public, so that other per-thread data (like hit counters) can be split
+the same way.
+
+Meets the requirements of std::shared_lock and std::unique_lock (and so also works with
+std::condition_variable_any). A reader has to unlock from the thread that locked.
+*/
+
+class ReadMostlyMutex {
+
+public:
+  static constexpr unsigned int SLOTS = 16;
+
+  ReadMostlyMutex() = default;
+  ReadMostlyMutex(const ReadMostlyMutex&) = delete;
+  ReadMostlyMutex& operator=(const ReadMostlyMutex&) = delete;
+
+  void lock_shared() {
+    m_slots[getThreadSlot()].mutex.lock_shared();
+  }
+
+  void unlock_shared() {
+    m_slots[getThreadSlot()].mutex.unlock_shared();
+  }
+
+  void lock() {
+    // Always in the same order, so that two writers can't deadlock
+    for (Slot& slot: m_slots)
+      slot.mutex.lock();
+  }
+
+  bool try_lock() {
+    for (unsigned int i = 0; i < SLOTS; i++) {
+      if (!m_slots[i].mutex.try_lock()) {
+        while (i > 0)
+          m_slots[--i].mutex.unlock();
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void unlock() {
+    for (unsigned int i = SLOTS; i > 0; i--)
+      m_slots[i - 1].mutex.unlock();
+  }
+
+  /**
+   * @brief The slot of the calling thread; threads are given slots in turn as they first ask
+   */
+  static unsigned int getThreadSlot() {
+    static std::atomic<unsigned int> next{0};
+    thread_local unsigned int slot = next.fetch_add(1, std::memory_order_relaxed) % SLOTS;
+    return slot;
+  }
+
+private:
+  struct alignas(64) Slot {
+    std::shared_mutex mutex;
+  };
+
+  Slot m_slots[SLOTS];
+};
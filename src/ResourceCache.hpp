@@ -0,0 +1,1909 @@
+/*
+DEPENDENCIES:
+AccessTrace
+std::string
+std::string_view
+std::unordered_map
+std::list
+std::filesystem
+AsyncLoader
+DecodedCache
+FileScan
+hashBytes
+MappedFile
+PathHash
+ResourceHandle
+ResourceId
+ResourcePack
+ResourceStats
+ReadMostlyMutex
+ResourcePool
+*/
+
+#pragma once
+
+#include "AccessTrace.hpp"
+#include "AsyncLoader.hpp"
+#include "DecodedCache.hpp"
+#include "FileScan.hpp"
+#include "Hash.hpp"
+#include "MappedFile.hpp"
+#include "PathHash.hpp"
+#include "ResourceHandle.hpp"
+#include "ResourceId.hpp"
+#include "ResourcePack.hpp"
+#include "ResourcePool.hpp"
+#include "ReadMostlyMutex.hpp"
+#include "ResourceStats.hpp"
+#include "RunParallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+/*
+The generic engine behind each of the resource types in ResourceManager. A ResourceCache
+holds every resource of type T that has been loaded, keyed by file path, and does the
+loading, pre loading, background requests and invalid file fallback for them. Everything
+that is specific to a type of resource is described by the Loader policy (see
+ResourceLoaders.hpp), so a new type of resource doesn't need any more code than its loader.
+
+Each cache can also be given a memory budget (in the units of Loader::getSize). Entries are
+kept in least recently used order, and once the budget is exceeded the oldest entries are
+deleted until the cache fits again. Keeping the order costs a single list splice on each hit.
+Entries that are held by a ResourceHandle are never evicted or unloaded.
+
+A path that can't be loaded points to a single invalid resource shared by every such path (loaded
+from the invalid path once), and keeps its entry, so that looking it up again costs a hash lookup
+rather than another trip to the disk. The entry is dropped by forgetFailed(), and reload() tries
+the file again, so a missing file that appears is picked up by hot reloading.
+
+The resources themselves are allocated from a ResourcePool rather than one by one, so that
+their slots are reused as entries come and go.
+
+Every entry is also indexed by the ResourceId of its path, so code that uses IDs (see
+ResourceId.hpp) skips building and hashing the path string on a hit.
+
+By default a cache is only meant to be used from one thread. In thread safe mode (see
+setThreadSafe), lookups can come from any number of threads: hits only take the calling
+thread's slot of a ReadMostlyMutex, and mark the entry as used rather than moving it in the
+LRU order (eviction gives marked entries a second chance instead), so hits on different
+threads don't touch each other. A miss is loaded by the first thread to ask for it, outside
+of the lock, while any other thread asking for the same path waits for that load.
+
+The first lookup of each path can also be added to an AccessTrace (see setTrace), so that the next
+run can prefetch the files before they are looked up.
+
+Lookups, loads and fallbacks are counted for each entry and for the whole cache (see
+ResourceStats.hpp), unless RESOURCE_STATS is defined as 0.
+
+If a ResourcePack is set, files are read straight out of the pack's memory mapping when they
+are in it, and pre loading a folder lists the pack instead of the filesystem.
+
+If a DecodedCache is set (and the loader supports it), files from the filesystem are decoded
+through it, so that unchanged files skip their decoder on later runs.
+
+With deduplication on, the contents of each file are hashed as it is loaded, and every path
+whose contents match a file that is already loaded shares that file's resource instead of
+decoding another copy. The shared resource is counted against the budget once, and is only
+deleted when the last path using it is.
+*/
+
+/**
+ * @brief The hash for ResourceId keys, which are already well mixed
+ */
+struct IdHash {
+  std::size_t operator()(std::uint64_t id) const {
+    return static_cast<std::size_t>(id);
+  }
+};
+
+template<typename T, typename Loader>
+class ResourceCache {
+
+public:
+  typedef T Resource;
+  typedef typename Loader::Decoded Decoded;
+
+  ResourceCache(): m_invalidPath(Loader::DEFAULT_INVALID_PATH) {}
+
+  ResourceCache(const ResourceCache&) = delete;
+  ResourceCache& operator=(const ResourceCache&) = delete;
+
+  ~ResourceCache() {
+    // Everything goes here, held or not, since handles can't outlive the cache
+    for (auto& element: m_map) {
+      if (element.second.resource != m_placeholder && element.second.resource != m_invalid && !element.second.deduplicated)
+        m_pool.destroy(element.second.resource);
+    }
+    for (auto& element: m_contents)
+      m_pool.destroy(element.second.resource);
+    m_pool.destroy(m_placeholder);
+    m_pool.destroy(m_invalid);
+  }
+
+  /**
+   * @brief Get the resource that is at the given file path, loading it if it hasn't been already.
+   * If the file can't be loaded, the shared invalid resource is returned instead, and the path is
+   * remembered as missing so that later lookups don't go to the disk again (see forgetFailed).
+   *
+   * A file that is still pending from request() or prefetch() is loaded right away, since the
+   * pointer returned here can't follow the entry once the request is finished.
+   *
+   * @param filePath The (relative to project folder or absolute) location of the file
+   * @param record Whether the lookup is added to the trace (see setTrace); the manager's own
+   * lookups, like loading a bundle, aren't
+   * @return T* A pointer to the resource at the given file path
+   */
+  T* get(std::string_view filePath, bool record = true) {
+    if (m_threadSafe)
+      return getConcurrent(filePath, record);
+
+    // The lookup is done directly with the string_view, so no key string is built on a hit
+    auto it = m_map.find(filePath);
+
+    if (it != m_map.end()) {
+      Entry& entry = it->second;
+      touch(entry);
+      recordHit(entry);
+      if (record)
+        recordAccess(entry);
+
+      // The background decode is dropped when it finishes, as the entry no longer has the placeholder
+      if (entry.resource == m_placeholder) {
+        Decoding decoding;
+        if (m_deduplicate)
+          readSource(it->first, decoding.source);
+        finish(entry, decoding);
+        account(entry);
+      }
+      return entry.resource;
+    }
+
+    // If the code has made it to this point, it hasn't found a matching entry in the map.
+    // The resource is created in the cache's pool, and lives until the entry is removed
+    std::string path(filePath);
+    LoadTimer timer;
+
+    // With a decoded cache, going through decode() lets unchanged files skip their decoder.
+    // Contents that are already loaded under another path aren't decoded at all
+    if (m_deduplicate || usesDecodedCache()) {
+      Decoding decoding;
+      if (m_deduplicate)
+        readSource(path, decoding.source);
+
+      Entry& entry = insert(std::move(path));
+      recordMiss(entry);
+      if (record)
+        recordAccess(entry);
+      finish(entry, decoding);
+      account(entry);
+      return entry.resource;
+    }
+
+    T* resource = m_pool.create();
+
+    // If the resource doesn't load properly, the path gets the shared invalid resource instead
+    std::uint32_t variant = getVariant();
+    bool loaded = loadResource(*resource, path, variant);
+    if (!loaded) {
+      m_pool.destroy(resource);
+      resource = getInvalid();
+    }
+
+    Entry& entry = insert(std::move(path));
+    entry.resource = resource;
+    entry.variant = variant;
+    recordMiss(entry);
+    if (record)
+      recordAccess(entry);
+    recordLoad(entry, timer.getSeconds(), !loaded);
+    account(entry);
+
+    return resource;
+  }
+
+  /**
+   * @brief Get the resource with the given ID, loading it from the ID's path if it hasn't been already.
+   * In debug builds, the path of the entry found is checked against the ID's path, so that two paths
+   * with the same hash don't silently share a resource.
+   *
+   * @param id The ID of the resource, see RES_ID
+   * @param record Whether the lookup is added to the trace, as with get(filePath)
+   * @return T* A pointer to the resource
+   */
+  T* get(const ResourceId& id, bool record = true) {
+    {
+      auto lock = lockShared();
+
+      // Pending entries are left to get(filePath), which loads them
+      auto it = m_ids.find(id.getHash());
+      if (it != m_ids.end() && !it->second->loading && it->second->resource != m_placeholder) {
+        Entry& entry = *it->second;
+        assert(**entry.lruPosition == id.getPath() && "Two resource paths have the same ResourceId");
+
+        touchOrMark(entry);
+        recordSharedHit(entry);
+        if (record)
+          recordAccess(entry);
+        return entry.resource;
+      }
+    }
+
+    return get(id.getPath(), record);
+  }
+
+  /**
+   * @brief Request the resource at the given file path without blocking. If it hasn't been loaded yet,
+   * the file is decoded by the given loader in the background, and the returned handle will point to
+   * the placeholder until the finalizer has been run by AsyncLoader's owner. A get() for the path in
+   * the meantime loads it right away instead.
+   *
+   * @param filePath The (relative to project folder or absolute) location of the file
+   * @param loader The background loader that should decode the file
+   * @return ResourceHandle<T> A handle that follows the entry for the path
+   */
+  ResourceHandle<T> request(std::string_view filePath, AsyncLoader& loader) {
+    auto lock = lockExclusive();
+    T* placeholder = getPlaceholder();
+
+    // If there is already an entry (loaded or pending) we just point at that
+    auto it = m_map.find(filePath);
+    if (it != m_map.end()) {
+      touch(it->second);
+      recordHit(it->second);
+      recordAccess(it->second);
+      return ResourceHandle<T>(&it->second, placeholder);
+    }
+
+    // Otherwise the entry points to the placeholder until the request is finished
+    Entry& entry = queue(std::string(filePath), loader);
+    recordMiss(entry);
+    recordAccess(entry);
+
+    return ResourceHandle<T>(&entry, placeholder);
+  }
+
+  /**
+   * @brief Start loading a file in the background (as with request()) ahead of it being looked up.
+   * Unlike a request, this isn't a lookup: it isn't counted in the stats or added to the trace.
+   *
+   * @param filePath The (relative to project folder or absolute) location of the file
+   * @param loader The background loader that should decode the file
+   * @return true The file was queued
+   * @return false The path is already loaded (or pending)
+   */
+  bool prefetch(std::string_view filePath, AsyncLoader& loader) {
+    auto lock = lockExclusive();
+    getPlaceholder();
+
+    if (m_map.find(filePath) != m_map.end())
+      return false;
+
+    queue(std::string(filePath), loader);
+    return true;
+  }
+
+  /**
+   * @brief Get a counted handle to the resource at the given file path, loading it (as with get())
+   * if it hasn't been already. The entry can't be evicted or unloaded while the handle exists.
+   *
+   * @param filePath The (relative to project folder or absolute) location of the file
+   * @param record Whether the lookup is added to the trace, as with get()
+   * @return ResourceHandle<T> A handle to the resource
+   */
+  ResourceHandle<T> acquire(std::string_view filePath, bool record = true) {
+    while (true) {
+      get(filePath, record);
+
+      // In a thread safe cache, another thread could have unloaded the entry in between
+      auto lock = lockExclusive();
+      auto it = m_map.find(filePath);
+      if (it != m_map.end() && !it->second.loading)
+        return ResourceHandle<T>(&it->second, m_placeholder);
+    }
+  }
+
+  /**
+   * @brief Load all of the files in a given folder whose file extensions appear in Loader::EXTENSIONS.
+   * The files are decoded across the given number of threads, and the resources are then created on
+   * the calling thread in path order, so the result doesn't depend on the number of threads.
+   * Files that have already been loaded are skipped, and with deduplication on, only the first file
+   * with each content is decoded.
+   *
+   * @param folderPath The (relative to project folder or absolute) location of the folder
+   * @param recurse Whether or not to search for files below the given folder
+   * @param threads The number of threads used to decode the files
+   */
+  void preLoad(const std::string& folderPath, bool recurse, unsigned int threads) {
+    preLoad(listFiles(folderPath, recurse), threads);
+  }
+
+  /**
+   * @brief Load the given files, as with preLoad(folderPath, ...)
+   *
+   * @param files The paths of the files, sorted
+   * @param threads The number of threads used to decode the files
+   * @param handles If given, is filled with a handle to each of the files (in the same order), taken
+   * as its entry is created (or up front for files that were already loaded), so that a budget can't
+   * evict the files while the rest are still being loaded. A file that another thread is still loading
+   * gets an empty handle.
+   */
+  void preLoad(std::vector<std::string> files, unsigned int threads, std::vector<ResourceHandle<T>>* handles = nullptr) {
+    // Other threads can keep using the cache while the files are decoded
+    auto lock = lockShared();
+
+    // Anything already in the cache (but not pending) doesn't need to be read again
+    std::vector<std::size_t> toLoad;
+    for (std::size_t i = 0; i < files.size(); i++) {
+      if (!isLoadedOrLoading(files[i]))
+        toLoad.push_back(i);
+    }
+
+    std::vector<Decoding> decodings(files.size());
+    std::vector<std::size_t> toDecode;
+
+    if (m_deduplicate) {
+      // Everything is read and hashed first, so that each content is only decoded once, by
+      // the first file (in path order) that has it
+      runParallel(toLoad.size(), threads, [&](std::size_t i) {
+        readSource(files[toLoad[i]], decodings[toLoad[i]].source);
+      });
+
+      std::unordered_map<std::uint64_t, std::size_t> firstWithContent;
+      for (std::size_t i: toLoad) {
+        const Source& source = decodings[i].source;
+        if (source.found) {
+          if (findShared(source))
+            continue;
+
+          auto [it, inserted] = firstWithContent.try_emplace(source.hash, i);
+          if (!inserted && decodings[it->second].source.size == source.size)
+            continue;
+        }
+        toDecode.push_back(i);
+      }
+    } else {
+      toDecode = toLoad;
+    }
+
+    if (lock.owns_lock())
+      lock.unlock();
+
+    // Decoding is the expensive part, and doesn't touch the GL context, so it can be
+    // spread across the worker threads
+    runParallel(toDecode.size(), threads, [&](std::size_t i) {
+      decodeFile(files[toDecode[i]], decodings[toDecode[i]]);
+    });
+
+    auto exclusiveLock = lockExclusive();
+
+    // The files that are already loaded are held before any new ones are accounted for
+    if (handles) {
+      handles->clear();
+      handles->resize(files.size());
+      for (std::size_t i = 0; i < files.size(); i++) {
+        auto it = m_map.find(files[i]);
+        if (it != m_map.end() && !it->second.loading)
+          (*handles)[i] = ResourceHandle<T>(&it->second, m_placeholder);
+      }
+    }
+
+    for (std::size_t i: toLoad) {
+      // Another thread may have loaded the file in the meantime
+      if (isLoadedOrLoading(files[i]))
+        continue;
+
+      Entry& entry = insert(files[i]);
+      finish(entry, decodings[i]);
+      if (handles)
+        (*handles)[i] = ResourceHandle<T>(&entry, m_placeholder);
+      account(entry);
+    }
+  }
+
+  /**
+   * @brief Load the file at the given path again, into the resource that is already loaded for it, so
+   * that existing pointers and handles see the new contents. If the file can't be loaded (eg. it is
+   * still being written), the old contents are kept.
+   *
+   * A resource that is shared with other paths (see setDeduplicate) can't be changed in place without
+   * changing it for them as well, so this path is given its own resource instead. The same goes for a
+   * path that couldn't be loaded before, which is how a missing file that appears is picked up.
+   *
+   * @param filePath The path the resource was loaded with
+   * @return true The resource was reloaded
+   * @return false There is no loaded resource for the path, or the file couldn't be loaded
+   */
+  bool reload(std::string_view filePath) {
+    auto lock = lockExclusive();
+
+    auto it = m_map.find(filePath);
+    if (it == m_map.end() || it->second.resource == m_placeholder)
+      return false;
+
+    return reloadEntry(it->second, it->first, false);
+  }
+
+  /**
+   * @brief Load the resources that were loaded with a different Loader::getVariant() than the
+   * current one again (from the pack if it has the file), eg. the textures loaded before the
+   * resolution tier was changed. Resources are reloaded in place, so pointers to them stay valid;
+   * only a resource shared with other paths is swapped for a new one (see reload). With a decoded
+   * cache, files already decoded for the current variant are read from it instead of decoded again.
+   * Pending entries are skipped, so the variant should be changed between loads.
+   *
+   * @return int The number of resources that were reloaded
+   */
+  int reloadStale() {
+    auto lock = lockExclusive();
+    std::uint32_t variant = getVariant();
+
+    // Collected first, since reloading can evict other entries
+    std::vector<std::string> stale;
+    for (auto& element: m_map) {
+      const Entry& entry = element.second;
+      if (entry.variant != variant && entry.resource != m_placeholder && entry.resource != m_invalid && !entry.loading)
+        stale.push_back(element.first);
+    }
+
+    int reloaded = 0;
+    for (const std::string& path: stale) {
+      auto it = m_map.find(path);
+      if (it != m_map.end() && it->second.variant != variant && it->second.resource != m_invalid)
+        reloaded += reloadEntry(it->second, it->first, true);
+    }
+
+    return reloaded;
+  }
+
+  /**
+   * @brief Returns the number of entries in the cache
+   *
+   * @return int The number of entries loaded (or pending)
+   */
+  int size() const {
+    auto lock = lockShared();
+    return m_map.size();
+  }
+
+  /**
+   * @brief Mark the entry for a path as created for a group of resources (a bundle or a ResourceScope),
+   * so that unloading the group can leave alone the entries that were loaded before it took them,
+   * which the game may still be using through plain pointers. The mark goes with the entry.
+   */
+  void markGrouped(std::string_view filePath) {
+    auto lock = lockExclusive();
+    auto it = m_map.find(filePath);
+    if (it != m_map.end())
+      it->second.grouped = true;
+  }
+
+  /**
+   * @brief Whether there is an entry (loaded, failed or pending) for the given path
+   */
+  bool contains(std::string_view filePath) const {
+    auto lock = lockShared();
+    return m_map.find(filePath) != m_map.end();
+  }
+
+  /**
+   * @brief Delete all of the resources held by the cache and clear the respective entries.
+   * Entries that are still held by a handle are kept, as deleting them would leave the handle dangling.
+   */
+  void clear() {
+    unloadUnused();
+  }
+
+  /**
+   * @brief Delete the resources that aren't held by any ResourceHandle. Note that pointers returned
+   * by get() aren't counted, so they shouldn't be kept across this.
+   *
+   * @return int The number of entries that were unloaded
+   */
+  int unloadUnused() {
+    auto lock = lockExclusive();
+    int unloaded = 0;
+
+    auto position = m_lru.begin();
+    while (position != m_lru.end()) {
+      auto it = m_map.find(**position);
+      if (it->second.references > 0 || it->second.loading) {
+        position++;
+        continue;
+      }
+
+      position = m_lru.erase(position);
+      remove(it);
+      unloaded++;
+    }
+
+    return unloaded;
+  }
+
+  /**
+   * @brief Delete the resource at the given path, unless it is held by a ResourceHandle
+   *
+   * @param filePath The path the resource was loaded with
+   * @return true The resource was unloaded
+   * @return false There is no entry for the path, or it is still held
+   */
+  bool unload(std::string_view filePath) {
+    auto lock = lockExclusive();
+
+    auto it = m_map.find(filePath);
+    if (it == m_map.end() || it->second.references > 0 || it->second.loading)
+      return false;
+
+    m_lru.erase(it->second.lruPosition);
+    remove(it);
+    return true;
+  }
+
+  /**
+   * @brief Delete the resources at several paths at once, skipping the ones that are held by a
+   * ResourceHandle, with a single lock for all of them
+   *
+   * @param filePaths The paths the resources were loaded with
+   * @param groupedOnly Whether to also skip the entries that weren't created for a group (see markGrouped)
+   * @return int The number of resources that were unloaded
+   */
+  int unload(const std::vector<std::string>& filePaths, bool groupedOnly = false) {
+    auto lock = lockExclusive();
+    int unloaded = 0;
+
+    for (const std::string& path: filePaths) {
+      auto it = m_map.find(path);
+      if (it == m_map.end() || it->second.references > 0 || it->second.loading || (groupedOnly && !it->second.grouped))
+        continue;
+
+      m_lru.erase(it->second.lruPosition);
+      remove(it);
+      unloaded++;
+    }
+
+    return unloaded;
+  }
+
+  /**
+   * @brief Forget the paths that couldn't be loaded, so that the next lookup of each tries the file
+   * again. Paths that are held by a handle are tried again right away instead (see reload).
+   *
+   * @return int The number of paths that were forgotten or loaded
+   */
+  int forgetFailed() {
+    auto lock = lockExclusive();
+
+    // Collected first, since loading a held path can evict other entries
+    std::vector<std::string> failed;
+    for (auto& element: m_map) {
+      if (element.second.resource == m_invalid)
+        failed.push_back(element.first);
+    }
+
+    int forgotten = 0;
+    for (const std::string& path: failed) {
+      auto it = m_map.find(path);
+      if (it == m_map.end() || it->second.resource != m_invalid)
+        continue;
+
+      if (it->second.references > 0) {
+        forgotten += reloadEntry(it->second, it->first, false);
+        continue;
+      }
+
+      m_lru.erase(it->second.lruPosition);
+      remove(it);
+      forgotten++;
+    }
+
+    return forgotten;
+  }
+
+  /**
+   * @brief Set the maximum amount of memory that the resources in the cache should use. Whenever a
+   * new resource pushes the cache over this, the least recently used resources are deleted (and any
+   * pointers to them become invalid) until it fits again. Pending requests are never evicted.
+   *
+   * @param bytes The budget, as measured by Loader::getSize. 0 (the default) means no limit.
+   */
+  void setBudget(std::size_t bytes) {
+    auto lock = lockExclusive();
+    m_budget = bytes;
+    evict(nullptr);
+  }
+
+  /**
+   * @brief Get the memory budget of the cache
+   *
+   * @return std::size_t The budget in bytes, or 0 for no limit
+   */
+  std::size_t getBudget() const {
+    return m_budget;
+  }
+
+  /**
+   * @brief Get the amount of memory held by the resources in the cache
+   *
+   * @return std::size_t The total of Loader::getSize over every entry
+   */
+  std::size_t getBytes() const {
+    auto lock = lockShared();
+    return m_bytes;
+  }
+
+  /**
+   * @brief Get the amount of memory held by the resource at the given path
+   *
+   * @param filePath The path the resource was loaded with
+   * @return std::size_t Loader::getSize of the resource, or 0 if it isn't loaded (or is shared with
+   * a path that was loaded earlier)
+   */
+  std::size_t getBytes(std::string_view filePath) const {
+    auto lock = lockShared();
+    auto it = m_map.find(filePath);
+    return it == m_map.end() ? 0 : it->second.bytes;
+  }
+
+  /**
+   * @brief Take a copy of the counters for the cache, see ResourceStats.hpp
+   *
+   * @param includeEntries Whether to also copy the counters of every entry
+   * @return ResourceCacheStats The counters (with an empty type, for the caller to fill in)
+   */
+  ResourceCacheStats getStats(bool includeEntries) const {
+    auto lock = lockExclusive();
+
+    ResourceCacheStats stats;
+    stats.entries = m_map.size();
+    stats.bytes = m_bytes;
+    stats.budget = m_budget;
+    stats.deduplicatedBytes = m_deduplicatedBytes;
+
+#if RESOURCE_STATS
+    stats.hits = m_counters.getHits();
+    stats.misses = m_counters.misses;
+    stats.fallbacks = m_counters.fallbacks;
+    stats.loadSeconds = m_counters.loadSeconds;
+#endif
+
+    if (!includeEntries)
+      return stats;
+
+    stats.entryStats.reserve(m_map.size());
+    for (auto& element: m_map) {
+      ResourceEntryStats& entry = stats.entryStats.emplace_back();
+      entry.path = element.first;
+      entry.bytes = element.second.bytes;
+      entry.pending = element.second.resource == m_placeholder;
+      entry.failed = element.second.resource == m_invalid;
+
+#if RESOURCE_STATS
+      entry.loadSeconds = element.second.counters.loadSeconds;
+      entry.hits = element.second.counters.hits;
+      entry.lastAccess = element.second.counters.lastAccess;
+#endif
+    }
+
+    return stats;
+  }
+
+  /**
+   * @brief Set whether the cache can be used from several threads at once (see the top of
+   * ResourceCache.hpp). This itself has to be called while no other thread is using the cache, as do
+   * the other setters (setPack, setDecodedCache, setDeduplicate), which are meant to be called once
+   * up front. Requests still have to be finished on the thread that owns AsyncLoader.
+   *
+   * @param threadSafe Whether to lock around every access
+   */
+  void setThreadSafe(bool threadSafe) {
+    m_threadSafe = threadSafe;
+
+    // Handles only need atomic counts if they can be copied on other threads
+    for (auto& element: m_map)
+      element.second.threadSafe = threadSafe;
+
+#if RESOURCE_STATS
+    // Without the lock every hit is counted in hits, so the shards don't have to be summed
+    if (!threadSafe)
+      m_counters.foldSharedHits();
+#endif
+  }
+
+  bool isThreadSafe() const {
+    return m_threadSafe;
+  }
+
+  /**
+   * @brief Set whether files with identical contents should share a single resource. This only
+   * affects files loaded afterwards; resources that are already shared stay shared.
+   *
+   * @param deduplicate Whether to hash the contents of files as they are loaded
+   */
+  void setDeduplicate(bool deduplicate) {
+    m_deduplicate = deduplicate;
+  }
+
+  /**
+   * @brief Get the memory saved by deduplication, ie. the memory that the paths sharing a resource
+   * would have used if they had each loaded their own copy.
+   *
+   * @return std::size_t The memory saved, as measured by Loader::getSize
+   */
+  std::size_t getDeduplicatedBytes() const {
+    auto lock = lockShared();
+    return m_deduplicatedBytes;
+  }
+
+  /**
+   * @brief Set the file that will be used when another file can't be loaded. If the placeholder or the
+   * invalid resource have already been loaded, they are reloaded in place, so pointers and pending
+   * handles to them stay valid.
+   *
+   * @param filePath The new invalid file
+   */
+  void setInvalidPath(const std::string& filePath) {
+    auto lock = lockExclusive();
+    m_invalidPath = filePath;
+
+    if (m_placeholder)
+      loadResource(*m_placeholder, m_invalidPath, getVariant());
+    if (m_invalid)
+      loadResource(*m_invalid, m_invalidPath, getVariant());
+  }
+
+  /**
+   * @brief Get the file that will be used when another file can't be loaded.
+   *
+   * @return const std::string& The invalid file path
+   */
+  const std::string& getInvalidPath() const {
+    return m_invalidPath;
+  }
+
+  /**
+   * @brief Read files out of the given pack (when they are in it) instead of from the filesystem.
+   * The pack has to stay open for as long as it is set, and for as long as any resources that keep
+   * reading from their data (fonts) are in use.
+   *
+   * @param pack The pack to read from, or nullptr to only use the filesystem
+   */
+  void setPack(const ResourcePack* pack) {
+    m_pack = pack;
+  }
+
+  /**
+   * @brief Decode files from the filesystem through the given on disk cache, so that files that haven't
+   * changed since they were last decoded don't have to be decoded again. Only used if the loader has
+   * CACHE_DECODED.
+   *
+   * @param cache The cache to use, or nullptr to always decode the files
+   */
+  void setDecodedCache(const DecodedCache* cache) {
+    m_decodedCache = cache;
+  }
+
+  /**
+   * @brief Add the path of every entry to the given trace the first time it is looked up from now on
+   * (including entries that were already loaded). Preloading and prefetching don't count as lookups.
+   *
+   * @param trace The trace to record into, or nullptr to stop recording
+   * @param type The type that the cache's resources are recorded as
+   */
+  void setTrace(AccessTrace* trace, ResourceType type) {
+    auto lock = lockExclusive();
+    m_trace = trace;
+    m_traceType = type;
+
+    for (auto& element: m_map)
+      element.second.traced.store(false, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Get the resource that pending entries point to, loading it from the invalid path the first time.
+   * This is shared by every pending request, and is never deleted by clear(). In a thread safe cache,
+   * the first call has to be made while the cache is locked (or not yet in use by other threads).
+   *
+   * @return T* The placeholder resource
+   */
+  T* getPlaceholder() {
+    if (!m_placeholder) {
+      m_placeholder = m_pool.create();
+      loadResource(*m_placeholder, m_invalidPath, getVariant());
+    }
+    return m_placeholder;
+  }
+
+  /**
+   * @brief Collect the paths of the files that preLoad would load from a folder; from the pack if
+   * it has any, otherwise from the filesystem.
+   */
+  std::vector<std::string> listFiles(const std::string& folderPath, bool recurse) const {
+    // With a pack, the folder doesn't need to be scanned at all
+    std::vector<std::string> files;
+    if (m_pack)
+      files = findPackedFiles(folderPath, recurse);
+    if (files.empty())
+      files = findFiles(folderPath, recurse);
+
+    return files;
+  }
+
+  /**
+   * @brief Get the size of a file, in the pack if it has it, otherwise on the filesystem
+   *
+   * @return std::size_t The size in bytes, or 0 if the file doesn't exist
+   */
+  std::size_t getFileSize(const std::string& filePath) const {
+    const void* data;
+    std::size_t size;
+    if (m_pack && m_pack->find(filePath, data, size))
+      return size;
+
+    std::error_code error;
+    std::uintmax_t fileSize = std::filesystem::file_size(filePath, error);
+    return error ? 0 : static_cast<std::size_t>(fileSize);
+  }
+
+  /**
+   * @brief Collect the paths of all of the files in a folder with one of the loader's extensions,
+   * sorted so that the preload order doesn't depend on the directory iteration order.
+   */
+  static std::vector<std::string> findFiles(const std::string& folderPath, bool recurse) {
+    std::vector<std::string> files;
+
+    scanFiles(folderPath, recurse, [&](const std::filesystem::path& path) {
+      if (matchesExtension(path.extension(), Loader::EXTENSIONS))
+        files.push_back(path.string());
+    });
+
+    std::sort(files.begin(), files.end());
+    return files;
+  }
+
+  /**
+   * @brief Collect the paths of all of the files in the pack that are in a folder and have one of the
+   * loader's extensions, sorted by path.
+   */
+  std::vector<std::string> findPackedFiles(const std::string& folderPath, bool recurse) const {
+    std::vector<std::string> files;
+
+    scanPackedFiles(*m_pack, folderPath, recurse, [&](std::string_view path) {
+      if (matchesExtension(getPackedExtension(path), Loader::EXTENSIONS))
+        files.emplace_back(path);
+    });
+
+    std::sort(files.begin(), files.end());
+    return files;
+  }
+
+private:
+  /**
+   * @brief Load a resource from the pack if it has the file, otherwise from the filesystem
+   */
+  bool loadResource(T& resource, const std::string& filePath, std::uint32_t variant) const {
+    const void* data;
+    std::size_t size;
+    if (m_pack && m_pack->find(filePath, data, size))
+      return loadFromMemory(resource, data, size, variant);
+
+    return load(resource, filePath, variant);
+  }
+
+  /**
+   * The loader's functions, for the given variant. Loaders without variants don't take one
+   * (see ResourceLoaders.hpp).
+   */
+  static bool load(T& resource, const std::string& filePath, [[maybe_unused]] std::uint32_t variant) {
+    if constexpr (requires { Loader::getVariant(); })
+      return Loader::load(resource, filePath, variant);
+    else
+      return Loader::load(resource, filePath);
+  }
+
+  static bool loadFromMemory(T& resource, const void* data, std::size_t size, [[maybe_unused]] std::uint32_t variant) {
+    if constexpr (requires { Loader::getVariant(); })
+      return Loader::loadFromMemory(resource, data, size, variant);
+    else
+      return Loader::loadFromMemory(resource, data, size);
+  }
+
+  static bool decode(const std::string& filePath, Decoded& decoded, [[maybe_unused]] std::uint32_t variant) {
+    if constexpr (requires { Loader::getVariant(); })
+      return Loader::decode(filePath, decoded, variant);
+    else
+      return Loader::decode(filePath, decoded);
+  }
+
+  static bool decodeFromMemory(const void* data, std::size_t size, Decoded& decoded, [[maybe_unused]] std::uint32_t variant) {
+    if constexpr (requires { Loader::getVariant(); })
+      return Loader::decodeFromMemory(data, size, decoded, variant);
+    else
+      return Loader::decodeFromMemory(data, size, decoded);
+  }
+
+  /**
+   * @brief Takes no space when the loader doesn't need to retain its decoded data
+   */
+  struct NothingRetained {};
+
+  /**
+   * @brief The contents of a file, read (or mapped) up front so that they can be hashed
+   */
+  struct Source {
+    /**
+     * @brief The mapping of a file from the filesystem, or nullptr for a file in the pack.
+     * Shared so that the data pointer stays valid when the source is copied.
+     */
+    std::shared_ptr<MappedFile> file;
+
+    const void* data = nullptr;
+    std::size_t size = 0;
+    std::uint64_t hash = 0;
+
+    /**
+     * @brief The stamp of a file from the filesystem, taken before it was mapped, for the decoded
+     * cache entry made from it (only with a decoded cache)
+     */
+    DecodedCache::Stamp stamp;
+
+    /**
+     * @brief Whether the file was read; if not, it is loaded (and fails) as usual
+     */
+    bool found = false;
+  };
+
+  /**
+   * @brief A decoded cache entry that the resource is created from directly, without deserializing
+   * it first (for loaders with finalizeSerialized, see ResourceLoaders.hpp). It stays mapped until then.
+   */
+  struct Serialized {
+    std::shared_ptr<MappedFile> file;
+    const void* data = nullptr;
+    std::size_t size = 0;
+  };
+
+  static constexpr bool FINALIZES_SERIALIZED = requires(T& resource, const void* data, std::size_t size) {
+    Loader::finalizeSerialized(resource, data, size);
+  };
+
+  /**
+   * @brief Everything that the worker threads produce for a single file
+   */
+  struct Decoding {
+    Decoded decoded;
+    bool loaded = false;
+
+    /**
+     * @brief Set instead of decoded when the file was found in the decoded cache, and the loader can
+     * create the resource straight from the entry
+     */
+    Serialized serialized;
+
+    /**
+     * @brief Whether decodeFile() has been run (it is skipped for files that look like duplicates)
+     */
+    bool attempted = false;
+
+    /**
+     * @brief The time spent decoding, for the stats
+     */
+    double seconds = 0;
+
+    /**
+     * @brief The Loader::getVariant() when the file was decoded
+     */
+    std::uint32_t variant = 0;
+
+    /**
+     * @brief Only filled in when deduplicating
+     */
+    Source source;
+  };
+
+  /**
+   * @brief A resource that is shared between every path with the same contents
+   */
+  struct SharedContent {
+    T* resource = nullptr;
+
+    /**
+     * @brief The number of entries that point to the resource
+     */
+    unsigned int users = 0;
+
+    /**
+     * @brief The memory of the resource, counted once in m_bytes
+     */
+    std::size_t bytes = 0;
+
+    /**
+     * @brief The size of the file, checked along with the hash
+     */
+    std::size_t sourceSize = 0;
+
+    /**
+     * @brief The Loader::getVariant() the resource was loaded with
+     */
+    std::uint32_t variant = 0;
+
+    /**
+     * @brief The data that the resource reads from, for loaders with RETAIN_DECODED. It is kept here
+     * rather than by the entry that loaded it, since the resource can outlive that entry.
+     */
+    [[no_unique_address]] std::conditional_t<Loader::RETAIN_DECODED, Decoded, NothingRetained> retained;
+  };
+
+  /**
+   * @brief Decode a file from the pack if it has it, otherwise from the filesystem. Safe to call from
+   * worker threads.
+   */
+  bool decodeResource(const std::string& filePath, Decoded& decoded, std::uint32_t variant,
+                      Serialized* serialized = nullptr) const {
+    const void* data;
+    std::size_t size;
+    if (m_pack && m_pack->find(filePath, data, size))
+      return decodeFromMemory(data, size, decoded, variant);
+
+    return decodeCached(filePath, nullptr, decoded, variant, serialized);
+  }
+
+  /**
+   * @brief Decode a file from the filesystem, going through the decoded cache if there is one. If the
+   * contents of the file have already been read, they are decoded from memory instead.
+   *
+   * @param serialized If given (and the loader has finalizeSerialized), a decoded cache entry is kept
+   * mapped here instead of being deserialized into decoded
+   */
+  bool decodeCached(const std::string& filePath, const Source* source, Decoded& decoded, std::uint32_t variant,
+                    [[maybe_unused]] Serialized* serialized = nullptr) const {
+    if constexpr (Loader::CACHE_DECODED) {
+      if (m_decodedCache) {
+        // The stamp has to be from before the file was read, so that an entry never claims to be
+        // for a newer version of the file than the one that was decoded
+        DecodedCache::Stamp stamp = source ? source->stamp : DecodedCache::getStamp(filePath);
+
+        // A fresh entry means the decoder can be skipped entirely
+        auto file = std::make_shared<MappedFile>();
+        const void* data;
+        std::size_t size;
+        if (m_decodedCache->read(filePath, stamp, *file, data, size, variant)) {
+          // Rather than copying the entry out, it can stay mapped until the resource is created from it
+          if constexpr (FINALIZES_SERIALIZED) {
+            if (serialized) {
+              *serialized = Serialized{std::move(file), data, size};
+              return true;
+            }
+          }
+
+          if (Loader::deserialize(data, size, decoded))
+            return true;
+        }
+
+        // Otherwise we decode as usual, and store the result for next time
+        if (!decodeUncached(filePath, source, decoded, variant))
+          return false;
+
+        std::vector<char> bytes;
+        Loader::serialize(decoded, bytes);
+        m_decodedCache->write(filePath, stamp, bytes, variant);
+        return true;
+      }
+    }
+
+    return decodeUncached(filePath, source, decoded, variant);
+  }
+
+  static bool decodeUncached(const std::string& filePath, const Source* source, Decoded& decoded, std::uint32_t variant) {
+    if (source) {
+      // A resource that keeps reading from its data can't read from the mapping, whose pages change
+      // (or disappear) when the file is rewritten, eg. while hot reloading. It gets a copy instead, or
+      // failing that, the file is decoded as usual
+      if constexpr (Loader::RETAIN_DECODED) {
+        if constexpr (requires { Loader::copyFromMemory(source->data, source->size, decoded); })
+          return Loader::copyFromMemory(source->data, source->size, decoded);
+        else
+          return decode(filePath, decoded, variant);
+      }
+
+      return decodeFromMemory(source->data, source->size, decoded, variant);
+    }
+
+    return decode(filePath, decoded, variant);
+  }
+
+  /**
+   * @brief Decode a file, from its source if it has already been read. Safe to call from worker threads.
+   */
+  void decodeFile(const std::string& filePath, Decoding& decoding) const {
+    LoadTimer timer;
+    // The variant is only read once, so the result is always of the variant it is recorded as
+    std::uint32_t variant = decoding.variant = getVariant();
+    const Source& source = decoding.source;
+    if (!source.found)
+      decoding.loaded = decodeResource(filePath, decoding.decoded, variant, &decoding.serialized);
+    else if (source.file)
+      decoding.loaded = decodeCached(filePath, &source, decoding.decoded, variant, &decoding.serialized);
+    else
+      decoding.loaded = decodeFromMemory(source.data, source.size, decoding.decoded, variant);
+
+    decoding.seconds = timer.getSeconds();
+    decoding.attempted = true;
+  }
+
+  /**
+   * @brief Read (or find in the pack) the contents of a file, and hash them. Safe to call from
+   * worker threads.
+   */
+  bool readSource(const std::string& filePath, Source& source) const {
+    // Files in the pack are already in memory, and anything else is mapped rather than copied
+    if (!m_pack || !m_pack->find(filePath, source.data, source.size)) {
+      if (usesDecodedCache())
+        source.stamp = DecodedCache::getStamp(filePath);
+
+      auto file = std::make_shared<MappedFile>();
+      if (!file->open(filePath))
+        return false;
+
+      source.data = file->getData();
+      source.size = file->getSize();
+      source.file = std::move(file);
+    }
+
+    source.hash = hashBytes(source.data, source.size);
+    source.found = true;
+    return true;
+  }
+
+  /**
+   * @brief Find the resource already loaded with the same contents as a source, if there is one
+   */
+  SharedContent* findShared(const Source& source) {
+    if (!source.found)
+      return nullptr;
+
+    // A resource loaded with an older variant isn't handed out to new paths
+    auto it = m_contents.find(source.hash);
+    if (it == m_contents.end() || it->second.sourceSize != source.size || it->second.variant != getVariant())
+      return nullptr;
+
+    return &it->second;
+  }
+
+  /**
+   * @brief Whether files from the filesystem are decoded through the decoded cache
+   */
+  bool usesDecodedCache() const {
+    if constexpr (Loader::CACHE_DECODED)
+      return m_decodedCache != nullptr;
+    else
+      return false;
+  }
+
+  /**
+   * @brief The loader's current variant (see getVariant in ResourceLoaders.hpp), or 0 for a
+   * loader without variants
+   */
+  static std::uint32_t getVariant() {
+    if constexpr (requires { Loader::getVariant(); })
+      return Loader::getVariant();
+    else
+      return 0;
+  }
+
+  struct Entry: ResourceSlot<T> {
+    /**
+     * @brief The memory counted against the budget for this entry
+     */
+    std::size_t bytes = 0;
+
+    /**
+     * @brief The position of this entry in m_lru
+     */
+    typename std::list<const std::string*>::iterator lruPosition;
+
+    /**
+     * @brief The data the resource reads from, for loaders with RETAIN_DECODED, when the resource
+     * isn't shared (see attach)
+     */
+    [[no_unique_address]] std::conditional_t<Loader::RETAIN_DECODED, Decoded, NothingRetained> retained;
+
+    /**
+     * @brief The hash of the path, ie. the entry's ResourceId
+     */
+    std::uint64_t id = 0;
+
+    /**
+     * @brief Whether the resource is owned by m_contents (under contentHash) rather than the entry
+     */
+    bool deduplicated = false;
+    std::uint64_t contentHash = 0;
+
+    /**
+     * @brief The Loader::getVariant() the resource was loaded with, see reloadStale()
+     */
+    std::uint32_t variant = 0;
+
+    /**
+     * @brief Whether get() is loading the resource on some thread, see getConcurrent()
+     */
+    bool loading = false;
+
+    /**
+     * @brief Whether the entry was created for a group of resources, see markGrouped()
+     */
+    bool grouped = false;
+
+    /**
+     * @brief Set by hits in a thread safe cache instead of moving the entry in m_lru
+     */
+    std::atomic<bool> used{false};
+
+    /**
+     * @brief Whether the entry has been looked up since the trace was set, see recordAccess()
+     */
+    std::atomic<bool> traced{false};
+
+    /**
+     * @brief Empty when the stats are compiled out
+     */
+    [[no_unique_address]] EntryCounters counters;
+  };
+
+  /**
+   * @brief Get the entry for a path, adding an empty one (at the most recently used end) if
+   * there isn't one already.
+   */
+  Entry& insert(std::string filePath) {
+    auto [it, inserted] = m_map.try_emplace(std::move(filePath));
+
+    if (!inserted)
+      return it->second;
+
+    // The key lives in the map node, which never moves, so the list can point at it
+    Entry& entry = it->second;
+    entry.lruPosition = m_lru.insert(m_lru.end(), &it->first);
+    entry.threadSafe = m_threadSafe;
+
+    // If two paths ever have the same hash, the ID keeps referring to the first one
+    entry.id = hashString(it->first);
+    [[maybe_unused]] bool registered = m_ids.try_emplace(entry.id, &entry).second;
+    assert(registered && "Two resource paths have the same ResourceId");
+
+    return entry;
+  }
+
+  /**
+   * @brief Mark an entry as the most recently used one
+   */
+  void touch(Entry& entry) {
+    m_lru.splice(m_lru.end(), m_lru, entry.lruPosition);
+  }
+
+  /**
+   * @brief Mark an entry as recently used; by moving it when the cache is only used from one
+   * thread, and otherwise (when only a shared lock is held) by setting its used flag.
+   */
+  void touchOrMark(Entry& entry) {
+    if (!m_threadSafe) {
+      touch(entry);
+      return;
+    }
+
+    // Checking first means a hot entry's cache line isn't written to by every hit
+    if (!entry.used.load(std::memory_order_relaxed))
+      entry.used.store(true, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Whether a path has an entry that is loaded (or being loaded by get() on another thread),
+   * as opposed to no entry or one waiting for a background request
+   */
+  bool isLoadedOrLoading(std::string_view filePath) const {
+    auto it = m_map.find(filePath);
+    return it != m_map.end() && (it->second.resource != m_placeholder || it->second.loading);
+  }
+
+  /**
+   * @brief get() for a thread safe cache. Hits only take a shared lock, while the first thread to
+   * miss a path (or find it pending) loads it without holding the lock, and any other thread asking
+   * for it waits.
+   */
+  T* getConcurrent(std::string_view filePath, bool record) {
+    {
+      std::shared_lock<ReadMostlyMutex> lock(m_mutex);
+
+      auto it = m_map.find(filePath);
+      if (it != m_map.end() && !it->second.loading && it->second.resource != m_placeholder) {
+        touchOrMark(it->second);
+        recordSharedHit(it->second);
+        if (record)
+          recordAccess(it->second);
+        return it->second.resource;
+      }
+    }
+
+    std::unique_lock<ReadMostlyMutex> lock(m_mutex);
+
+    // Wait for whoever is already loading it
+    auto it = m_map.find(filePath);
+    while (it != m_map.end() && it->second.loading) {
+      m_loaded.wait(lock);
+      it = m_map.find(filePath);
+    }
+
+    bool pending = it != m_map.end();
+    if (pending) {
+      touch(it->second);
+      recordHit(it->second);
+      if (record)
+        recordAccess(it->second);
+      if (it->second.resource != m_placeholder)
+        return it->second.resource;
+    }
+
+    // The entry marks the path as being loaded, and points to the placeholder in case a handle
+    // is taken to it in the meantime. A pending entry already does, and its background decode is
+    // dropped when it finishes
+    std::string path(filePath);
+    Entry& entry = pending ? it->second : insert(path);
+    if (!pending) {
+      entry.resource = getPlaceholder();
+      recordMiss(entry);
+      if (record)
+        recordAccess(entry);
+    }
+    entry.loading = true;
+
+    // Loading entries are never evicted or unloaded, so the entry is still there after the lock
+    // is let go of, for reading (and hashing) the file as well as for decoding it
+    Decoding decoding;
+    if (m_deduplicate) {
+      lock.unlock();
+      readSource(path, decoding.source);
+      lock.lock();
+    }
+
+    T* resource = nullptr;
+    bool loaded = false;
+    LoadTimer timer;
+    if (!findShared(decoding.source)) {
+      lock.unlock();
+      decodeFile(path, decoding);
+      loaded = decoding.loaded;
+      resource = create(decoding, loaded);
+      lock.lock();
+    }
+
+    entry.loading = false;
+    if (!share(entry, decoding.source))
+      attach(entry, resource, decoding, loaded, decoding.seconds + timer.getSeconds());
+    else
+      m_pool.destroy(resource);
+    account(entry);
+
+    T* result = entry.resource;
+    lock.unlock();
+    m_loaded.notify_all();
+    return result;
+  }
+
+  std::unique_lock<ReadMostlyMutex> lockExclusive() const {
+    std::unique_lock<ReadMostlyMutex> lock(m_mutex, std::defer_lock);
+    if (m_threadSafe)
+      lock.lock();
+    return lock;
+  }
+
+  std::shared_lock<ReadMostlyMutex> lockShared() const {
+    std::shared_lock<ReadMostlyMutex> lock(m_mutex, std::defer_lock);
+    if (m_threadSafe)
+      lock.lock();
+    return lock;
+  }
+
+  /**
+   * @brief Count the memory of an entry's (new) resource against the budget, and evict other
+   * entries if that puts the cache over it.
+   */
+  void account(Entry& entry) {
+    m_bytes -= entry.bytes;
+    // A shared resource is counted once, by its SharedContent, and the invalid resource not at all
+    entry.bytes = entry.deduplicated || entry.resource == m_invalid ? 0 : measure(entry);
+    m_bytes += entry.bytes;
+
+    touch(entry);
+    evict(&entry);
+  }
+
+  /**
+   * @brief The memory used by an entry's resource, and its retained data
+   */
+  static std::size_t measure(const Entry& entry) {
+    std::size_t bytes = Loader::getSize(*entry.resource);
+    if constexpr (Loader::RETAIN_DECODED)
+      bytes += Loader::getDecodedSize(entry.retained);
+    return bytes;
+  }
+
+  /**
+   * @brief Get the resource shared by every path that couldn't be loaded, loading it from the invalid
+   * path the first time. It is kept apart from the placeholder, so that a failed entry still counts as
+   * finished for handles.
+   */
+  T* getInvalid() {
+    if (!m_invalid) {
+      m_invalid = m_pool.create();
+      loadResource(*m_invalid, m_invalidPath, getVariant());
+    }
+    return m_invalid;
+  }
+
+  /**
+   * @brief Delete the least recently used entries until the cache fits in the budget
+   *
+   * @param keep An entry that shouldn't be evicted (the one that was just loaded), or nullptr
+   */
+  void evict(const Entry* keep) {
+    if (m_budget == 0)
+      return;
+
+    auto position = m_lru.begin();
+    while (m_bytes > m_budget && position != m_lru.end()) {
+      auto it = m_map.find(**position);
+      Entry& entry = it->second;
+
+      // Pending (and loading) entries have nothing to free yet, failed entries only take up their
+      // key (and remember that the file is missing), and held entries are still in use
+      if (&entry == keep || entry.resource == m_placeholder || entry.resource == m_invalid || entry.references > 0) {
+        position++;
+        continue;
+      }
+
+      // An entry that was hit in a thread safe cache only marked itself, so it gets a second chance
+      if (entry.used.exchange(false, std::memory_order_relaxed)) {
+        auto next = std::next(position);
+        m_lru.splice(m_lru.end(), m_lru, position);
+        position = next;
+        continue;
+      }
+
+      position = m_lru.erase(position);
+      remove(it);
+    }
+  }
+
+  /**
+   * @brief Delete an entry's resource and remove it from the map. The entry's position in m_lru
+   * must already have been erased.
+   */
+  void remove(typename std::unordered_map<std::string, Entry, PathHash, std::equal_to<>>::iterator it) {
+    m_bytes -= it->second.bytes;
+
+    // Shared resources belong to m_contents, and the placeholder and invalid resource are never deleted
+    if (it->second.deduplicated)
+      release(it->second.contentHash);
+    else if (it->second.resource != m_placeholder && it->second.resource != m_invalid)
+      m_pool.destroy(it->second.resource);
+
+    auto id = m_ids.find(it->second.id);
+    if (id != m_ids.end() && id->second == &it->second)
+      m_ids.erase(id);
+
+    m_map.erase(it);
+  }
+
+  /**
+   * @brief Drop one user of a shared resource, deleting it along with the last user
+   */
+  void release(std::uint64_t contentHash) {
+    auto it = m_contents.find(contentHash);
+    SharedContent& shared = it->second;
+
+    if (--shared.users > 0) {
+      m_deduplicatedBytes -= shared.bytes;
+      return;
+    }
+
+    m_bytes -= shared.bytes;
+    m_pool.destroy(shared.resource);
+    m_contents.erase(it);
+  }
+
+  /**
+   * @brief Load a loaded (or failed) entry's file again, see reload()
+   *
+   * @param usePack Whether the pack is looked in first, as with a first load. Changed files
+   * are always on the filesystem, so reload() skips it.
+   */
+  bool reloadEntry(Entry& entry, const std::string& path, bool usePack) {
+    LoadTimer timer;
+    std::uint32_t variant = getVariant();
+    auto loadInto = [&](T& resource) {
+      // With a decoded cache, reloads go through it too, so that a variant change can use the
+      // entries already decoded for the new variant (and leaves them for next time)
+      if constexpr (!Loader::RETAIN_DECODED) {
+        if (usesDecodedCache()) {
+          Decoded decoded;
+          Serialized serialized;
+          bool decodedOk = usePack ? decodeResource(path, decoded, variant, &serialized)
+                                   : decodeCached(path, nullptr, decoded, variant, &serialized);
+          return decodedOk && finalizeDecoded(resource, decoded, serialized);
+        }
+      }
+
+      return usePack ? loadResource(resource, path, variant) : load(resource, path, variant);
+    };
+
+    // Some resources are emptied by a load that fails (sf::Font and sf::Music clean up first), so
+    // the file is always loaded into a new resource, which only replaces the old one once it has loaded
+    T* resource = m_pool.create();
+    if (!loadInto(*resource)) {
+      m_pool.destroy(resource);
+      return false;
+    }
+
+    bool failed = entry.resource == m_invalid;
+    if (failed || (entry.deduplicated && m_contents.find(entry.contentHash)->second.users > 1)) {
+      if (!failed)
+        release(entry.contentHash);
+      entry.resource = resource;
+    } else {
+      // The contents are moved into the old resource, so that pointers to it stay valid
+      if constexpr (std::is_move_assignable_v<T>) {
+        *entry.resource = std::move(*resource);
+        m_pool.destroy(resource);
+      } else {
+        // sf::Music can't be assigned to, so it is opened again in place. Opening only reads the
+        // header, which has just been read without a problem, so this isn't expected to fail
+        m_pool.destroy(resource);
+        if (!loadInto(*entry.resource))
+          return false;
+      }
+
+      // The only user of a shared resource takes it back, since its contents no longer match the hash
+      if (entry.deduplicated) {
+        auto shared = m_contents.find(entry.contentHash);
+        m_bytes -= shared->second.bytes;
+        m_contents.erase(shared);
+      }
+    }
+
+    // The resource now reads from the file itself, not the data it was decoded from
+    if constexpr (Loader::RETAIN_DECODED)
+      entry.retained = Decoded();
+
+    entry.deduplicated = false;
+    entry.variant = variant;
+    recordLoad(entry, timer.getSeconds(), false);
+    account(entry);
+    return true;
+  }
+
+  /**
+   * @brief Create a resource from decoded data. Doesn't touch the entries, so it can be called
+   * without the lock.
+   *
+   * @param decoding The decoded data; for loaders with RETAIN_DECODED, this has to be moved into
+   * the entry afterwards (see attach)
+   * @param loaded Whether the data was decoded successfully, and is set to whether the
+   * resource was created from it
+   * @return T* The new resource, or nullptr if it couldn't be created (attach() then gives the
+   * entry the invalid resource)
+   */
+  T* create(Decoding& decoding, bool& loaded) {
+    if (!loaded)
+      return nullptr;
+
+    T* resource = m_pool.create();
+    loaded = finalizeDecoded(*resource, decoding.decoded, decoding.serialized);
+    if (!loaded) {
+      m_pool.destroy(resource);
+      return nullptr;
+    }
+
+    return resource;
+  }
+
+  /**
+   * @brief Create a resource from either its decoded data or a mapped decoded cache entry, which is
+   * unmapped afterwards
+   */
+  static bool finalizeDecoded(T& resource, Decoded& decoded, [[maybe_unused]] Serialized& serialized) {
+    if constexpr (FINALIZES_SERIALIZED) {
+      if (serialized.file) {
+        bool finalized = Loader::finalizeSerialized(resource, serialized.data, serialized.size);
+        serialized = Serialized();
+        return finalized;
+      }
+    }
+
+    return Loader::finalize(resource, decoded);
+  }
+
+  /**
+   * @brief Point a new entry at the resource already loaded with the same contents, if there is one
+   *
+   * @return true The entry now shares that resource
+   * @return false There is no resource to share
+   */
+  bool share(Entry& entry, const Source& source) {
+    SharedContent* shared = findShared(source);
+    if (!shared)
+      return false;
+
+    entry.resource = shared->resource;
+    entry.deduplicated = true;
+    entry.contentHash = source.hash;
+    entry.variant = shared->variant;
+
+    shared->users++;
+    m_deduplicatedBytes += shared->bytes;
+    return true;
+  }
+
+  /**
+   * @brief Point a new entry at a resource made by create(), keeping the data it reads from, and
+   * share it with later paths if the contents were hashed.
+   */
+  void attach(Entry& entry, T* resource, Decoding& decoding, bool loaded, double seconds) {
+    entry.resource = resource ? resource : getInvalid();
+    entry.variant = decoding.variant;
+    recordLoad(entry, seconds, !loaded);
+
+    // Moving the decoded data doesn't move the buffers that the resource reads from
+    if constexpr (Loader::RETAIN_DECODED) {
+      if (loaded)
+        entry.retained = std::move(decoding.decoded);
+    }
+
+    // The invalid resource is already shared
+    const Source& source = decoding.source;
+    if (!loaded || !source.found)
+      return;
+
+    // In the (unlikely) case of two different sizes with the same hash, the second isn't shared,
+    // and keeps the data its resource reads from itself
+    auto [it, inserted] = m_contents.try_emplace(source.hash);
+    if (!inserted)
+      return;
+
+    SharedContent& shared = it->second;
+    shared.resource = resource;
+    shared.users = 1;
+    shared.bytes = measure(entry);
+    shared.sourceSize = source.size;
+    shared.variant = decoding.variant;
+    if constexpr (Loader::RETAIN_DECODED) {
+      shared.retained = std::move(entry.retained);
+      entry.retained = Decoded();
+    }
+
+    m_bytes += shared.bytes;
+    entry.deduplicated = true;
+    entry.contentHash = source.hash;
+  }
+
+  /**
+   * @brief Point a new entry at its resource; either the shared one with the same contents, or
+   * one created from the decoded data (decoding the file first if that was skipped).
+   */
+  void finish(Entry& entry, Decoding& decoding) {
+    if (share(entry, decoding.source))
+      return;
+
+    // The file is only skipped up front when it looked like a duplicate
+    if (!decoding.attempted)
+      decodeFile(**entry.lruPosition, decoding);
+
+    LoadTimer timer;
+    bool loaded = decoding.loaded;
+    T* resource = create(decoding, loaded);
+    attach(entry, resource, decoding, loaded, decoding.seconds + timer.getSeconds());
+  }
+
+  /**
+   * @brief Count a lookup that found its entry, under the exclusive lock
+   */
+  void recordHit([[maybe_unused]] Entry& entry) {
+#if RESOURCE_STATS
+    entry.counters.lastAccess = getLookups();
+    entry.counters.hits++;
+    m_counters.hits++;
+#endif
+  }
+
+  /**
+   * @brief Count a lookup that found its entry under the shared lock. In a thread safe cache,
+   * only the calling thread's shard of the hits is written (see the top of ResourceStats.hpp).
+   */
+  void recordSharedHit([[maybe_unused]] Entry& entry) {
+#if RESOURCE_STATS
+    if (!m_threadSafe) {
+      recordHit(entry);
+      return;
+    }
+
+    m_counters.sharedHits[ReadMostlyMutex::getThreadSlot()].hits.fetch_add(1, std::memory_order_relaxed);
+#endif
+  }
+
+  /**
+   * @brief Count a lookup that had to add its entry
+   */
+  void recordMiss([[maybe_unused]] Entry& entry) {
+#if RESOURCE_STATS
+    entry.counters.lastAccess = getLookups();
+    m_counters.misses++;
+#endif
+  }
+
+#if RESOURCE_STATS
+  /**
+   * @brief The number of lookups so far. The shards are only summed in a thread safe cache, since
+   * they are empty otherwise (see setThreadSafe).
+   */
+  std::uint64_t getLookups() const {
+    return (m_threadSafe ? m_counters.getHits() : m_counters.hits) + m_counters.misses;
+  }
+#endif
+
+  /**
+   * @brief Add an entry's path to the trace the first time it is looked up. Only costs a pointer
+   * check when there is no trace, and a plain load once the entry has been traced.
+   */
+  void recordAccess(Entry& entry) {
+    if (m_trace && !entry.traced.load(std::memory_order_relaxed) &&
+        !entry.traced.exchange(true, std::memory_order_relaxed))
+      m_trace->record(m_traceType, **entry.lruPosition);
+  }
+
+  /**
+   * @brief Add an entry for a path that points to the placeholder, and decode the file on the
+   * background loader. The cache has to be locked, and the placeholder loaded.
+   */
+  Entry& queue(std::string path, AsyncLoader& loader) {
+    Entry& entry = insert(path);
+    entry.resource = m_placeholder;
+
+    // The shared contents can't be looked at from the worker, so a duplicate is still decoded,
+    // and then dropped in favour of the shared resource when the request is finished
+    bool deduplicate = m_deduplicate;
+    loader.push([this, path = std::move(path), deduplicate]() -> std::function<void()> {
+      Decoding decoding;
+      if (deduplicate)
+        readSource(path, decoding.source);
+      decodeFile(path, decoding);
+
+      // This part is run on the thread that owns the cache
+      return [this, path, decoding = std::move(decoding)]() mutable {
+        finishRequest(path, decoding);
+      };
+    });
+
+    return entry;
+  }
+
+  /**
+   * @brief Count the time spent loading an entry, and whether it had to use the invalid file
+   */
+  void recordLoad([[maybe_unused]] Entry& entry, [[maybe_unused]] double seconds, [[maybe_unused]] bool fellBack) {
+#if RESOURCE_STATS
+    entry.counters.loadSeconds += seconds;
+    m_counters.loadSeconds += seconds;
+    m_counters.fallbacks += fellBack;
+#endif
+  }
+
+  /**
+   * @brief Swap the placeholder of a pending entry for the resource created from the decoded data
+   */
+  void finishRequest(const std::string& filePath, Decoding& decoding) {
+    auto lock = lockExclusive();
+
+    // The entry may have been cleared (or loaded some other way) in the meantime
+    auto it = m_map.find(filePath);
+    if (it == m_map.end() || it->second.resource != m_placeholder || it->second.loading)
+      return;
+
+    finish(it->second, decoding);
+    account(it->second);
+  }
+
+  /**
+   * @brief The entries, keyed by the path to the file, such that we can differentiate between
+   * similarly named files in different locations. Combined with PathHash and std::equal_to<>,
+   * a cache hit costs a single hash and no allocation.
+   */
+  std::unordered_map<std::string, Entry, PathHash, std::equal_to<>> m_map;
+
+  /**
+   * @brief The entries again, keyed by the ResourceId of their path
+   */
+  std::unordered_map<std::uint64_t, Entry*, IdHash> m_ids;
+
+  /**
+   * @brief Every key in m_map, from least to most recently used
+   */
+  std::list<const std::string*> m_lru;
+
+  /**
+   * @brief The memory budget (0 for none) and the memory currently used, see setBudget()
+   */
+  std::size_t m_budget = 0;
+  std::size_t m_bytes = 0;
+
+  /**
+   * @brief The current location of the file that will be used if another file isn't found
+   */
+  std::string m_invalidPath;
+
+  /**
+   * @brief The pack that files are read from first, see setPack()
+   */
+  const ResourcePack* m_pack = nullptr;
+
+  /**
+   * @brief The on disk cache of decoded files, see setDecodedCache()
+   */
+  const DecodedCache* m_decodedCache = nullptr;
+
+  /**
+   * @brief The resources shared by paths with the same contents, keyed by the hash of the contents
+   */
+  std::unordered_map<std::uint64_t, SharedContent> m_contents;
+
+  /**
+   * @brief Whether files are deduplicated, and the memory that has saved, see setDeduplicate()
+   */
+  bool m_deduplicate = false;
+  std::size_t m_deduplicatedBytes = 0;
+
+  /**
+   * @brief The counts for the whole cache, see getStats()
+   */
+  [[no_unique_address]] CacheCounters m_counters;
+
+  /**
+   * @brief The lock used in thread safe mode, and the condition that threads waiting for another
+   * thread's load wait on, see getConcurrent()
+   */
+  mutable ReadMostlyMutex m_mutex;
+  std::condition_variable_any m_loaded;
+  bool m_threadSafe = false;
+
+  /**
+   * @brief The trace that first lookups are recorded into, see setTrace()
+   */
+  AccessTrace* m_trace = nullptr;
+  ResourceType m_traceType = ResourceType::Texture;
+
+  /**
+   * @brief Where every resource of the cache is allocated, see ResourcePool.hpp
+   */
+  ResourcePool<T> m_pool;
+
+  /**
+   * @brief The resource that pending entries point to, see getPlaceholder()
+   */
+  T* m_placeholder = nullptr;
+
+  /**
+   * @brief The resource that every path that couldn't be loaded points to, see getInvalid()
+   */
+  T* m_invalid = nullptr;
+};
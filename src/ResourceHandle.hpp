@@ -0,0 +1,140 @@
+/*
+DEPENDENCIES:
+std::atomic
+std::swap
+*/
+
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+/*
+A counted handle to a resource held by a ResourceCache (see ResourceManager::getTextureHandle
+and ResourceManager::requestTexture).
+
+The handle refers to the cache's entry for the path, rather than the resource itself, so a
+handle from a background request automatically moves from the placeholder (invalid) resource
+to the real one once the load has been finished. As long as a handle to an entry exists, the
+entry won't be evicted or unloaded by the cache.
+
+The reference count and resource pointer are atomic, so that handles can be copied and read
+on other threads when the cache is thread safe (see ResourceCache::setThreadSafe). Otherwise
+the count is changed with a plain load and store rather than a locked increment, so copying a
+handle is just a pointer copy and an ordinary add.
+*/
+
+/**
+ * @brief The part of a cache entry that handles refer to
+ */
+template<typename T>
+struct ResourceSlot {
+  std::atomic<T*> resource{nullptr};
+  std::atomic<unsigned int> references{0};
+
+  /**
+   * @brief Whether handles to the entry can be copied on several threads at once, set by the cache
+   */
+  bool threadSafe = false;
+};
+
+template<typename T>
+class ResourceHandle {
+
+public:
+  ResourceHandle() = default;
+
+  /**
+   * @brief Create a handle that follows (and holds a reference to) the given entry
+   *
+   * @param slot The entry held by the resource cache
+   * @param placeholder The resource that the entry points to until loading has finished
+   */
+  ResourceHandle(ResourceSlot<T>* slot, const T* placeholder): m_slot(slot), m_placeholder(placeholder) {
+    retain();
+  }
+
+  ResourceHandle(const ResourceHandle& other): m_slot(other.m_slot), m_placeholder(other.m_placeholder) {
+    retain();
+  }
+
+  ResourceHandle(ResourceHandle&& other) noexcept: m_slot(other.m_slot), m_placeholder(other.m_placeholder) {
+    other.m_slot = nullptr;
+  }
+
+  ResourceHandle& operator=(ResourceHandle other) noexcept {
+    // Copy and swap, so that self assignment is safe
+    std::swap(m_slot, other.m_slot);
+    std::swap(m_placeholder, other.m_placeholder);
+    return *this;
+  }
+
+  ~ResourceHandle() {
+    release();
+  }
+
+  /**
+   * @brief Get the current resource; either the placeholder or the loaded resource
+   *
+   * @return T* A pointer to the resource, or nullptr for an empty handle
+   */
+  T* get() const {
+    return m_slot ? m_slot->resource.load(std::memory_order_acquire) : nullptr;
+  }
+
+  T& operator*() const {
+    return *get();
+  }
+
+  T* operator->() const {
+    return get();
+  }
+
+  explicit operator bool() const {
+    return m_slot != nullptr;
+  }
+
+  /**
+   * @brief Whether the background load has finished and the handle now points at the real resource.
+   * Note that if the file couldn't be loaded, this will still be true and the handle will point at the
+   * shared invalid resource (as with getTexture etc.).
+   *
+   * @return true The resource has been loaded
+   * @return false The handle is still pointing at the placeholder
+   */
+  bool isLoaded() const {
+    return m_slot && m_slot->resource.load(std::memory_order_acquire) != m_placeholder;
+  }
+
+  /**
+   * @brief Drop this handle's reference, leaving it empty
+   */
+  void reset() {
+    release();
+    m_slot = nullptr;
+  }
+
+private:
+  void retain() {
+    if (!m_slot)
+      return;
+
+    if (m_slot->threadSafe)
+      m_slot->references.fetch_add(1, std::memory_order_relaxed);
+    else
+      m_slot->references.store(m_slot->references.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+
+  void release() {
+    if (!m_slot)
+      return;
+
+    if (m_slot->threadSafe)
+      m_slot->references.fetch_sub(1, std::memory_order_acq_rel);
+    else
+      m_slot->references.store(m_slot->references.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+  }
+
+  ResourceSlot<T>* m_slot = nullptr;
+  const T* m_placeholder = nullptr;
+};
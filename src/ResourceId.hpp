@@ -0,0 +1,65 @@
+/*
+DEPENDENCIES:
+hashString
+std::string_view
+*/
+
+#pragma once
+
+#include "Hash.hpp"
+
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+/*
+An identifier for a resource, made from its path. The hash is the same one the caches use to
+index their entries, so a lookup with an ID doesn't need to build or hash a string at all.
+
+For paths written in the code, use the RES_ID macro, which hashes the literal at compile time:
+
+  sf::Texture* grass = ResourceManager::getTexture(RES_ID("tiles/grass.png"));
+
+Paths only known at runtime can be turned into the same IDs with the string_view constructor.
+The path is kept (as a view) so that the resource can still be loaded the first time.
+*/
+
+class ResourceId {
+
+public:
+  /**
+   * @brief Create an ID from an already computed hash, see RES_ID
+   *
+   * @param hash The hashString() of the path
+   * @param path The path itself, which has to outlive the ID
+   */
+  constexpr ResourceId(std::uint64_t hash, std::string_view path): m_hash(hash), m_path(path) {}
+
+  /**
+   * @brief Create an ID from a path, hashing it at runtime
+   *
+   * @param path The path, which has to outlive the ID
+   */
+  constexpr explicit ResourceId(std::string_view path): m_hash(hashString(path)), m_path(path) {}
+
+  constexpr std::uint64_t getHash() const {
+    return m_hash;
+  }
+
+  constexpr std::string_view getPath() const {
+    return m_path;
+  }
+
+  constexpr bool operator==(const ResourceId& other) const {
+    return m_hash == other.m_hash;
+  }
+
+private:
+  std::uint64_t m_hash;
+  std::string_view m_path;
+};
+
+/**
+ * @brief Make a ResourceId from a string literal, with the hash forced to be computed at compile time
+ */
+#define RES_ID(path) ResourceId(std::integral_constant<std::uint64_t, hashString(path)>::value, path)
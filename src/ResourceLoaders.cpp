@@ -0,0 +1,136 @@
+#include "ResourceLoaders.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+void TextureLoader::serialize(const Decoded& image, std::vector<char>& bytes) {
+  std::uint32_t size[2] = {image.getSize().x, image.getSize().y};
+  std::size_t pixels = static_cast<std::size_t>(size[0]) * size[1] * 4;
+
+  bytes.resize(sizeof(size) + pixels);
+  std::memcpy(bytes.data(), size, sizeof(size));
+  if (pixels > 0)
+    std::memcpy(bytes.data() + sizeof(size), image.getPixelsPtr(), pixels);
+}
+
+// Checks the layout of a serialized image, and finds its pixels
+static const sf::Uint8* findPixels(const void* data, std::size_t size, std::uint32_t (&dimensions)[2]) {
+  if (size < sizeof(dimensions))
+    return nullptr;
+
+  std::memcpy(dimensions, data, sizeof(dimensions));
+  std::size_t pixels = static_cast<std::size_t>(dimensions[0]) * dimensions[1] * 4;
+  if (pixels == 0 || size != sizeof(dimensions) + pixels)
+    return nullptr;
+
+  return static_cast<const sf::Uint8*>(data) + sizeof(dimensions);
+}
+
+bool TextureLoader::deserialize(const void* data, std::size_t size, Decoded& image) {
+  std::uint32_t dimensions[2];
+  const sf::Uint8* pixels = findPixels(data, size, dimensions);
+  if (!pixels)
+    return false;
+
+  image.create(dimensions[0], dimensions[1], pixels);
+  return true;
+}
+
+bool TextureLoader::finalizeSerialized(sf::Texture& texture, const void* data, std::size_t size) {
+  std::uint32_t dimensions[2];
+  const sf::Uint8* pixels = findPixels(data, size, dimensions);
+  if (!pixels || !texture.create(dimensions[0], dimensions[1]))
+    return false;
+
+  // Uploaded straight from the mapping, without an sf::Image in between
+  texture.update(pixels);
+  return true;
+}
+
+// Reads every sample out of an opened sound file
+static void readSamples(sf::InputSoundFile& file, SoundBufferLoader::Decoded& sound) {
+  sound.samples.resize(static_cast<std::size_t>(file.getSampleCount()));
+  sound.samples.resize(static_cast<std::size_t>(file.read(sound.samples.data(), sound.samples.size())));
+  sound.channelCount = file.getChannelCount();
+  sound.sampleRate = file.getSampleRate();
+}
+
+bool SoundBufferLoader::decode(const std::string& filePath, Decoded& sound) {
+  sf::InputSoundFile file;
+  if (!file.openFromFile(filePath))
+    return false;
+
+  readSamples(file, sound);
+  return true;
+}
+
+bool SoundBufferLoader::decodeFromMemory(const void* data, std::size_t size, Decoded& sound) {
+  sf::InputSoundFile file;
+  if (!file.openFromMemory(data, size))
+    return false;
+
+  readSamples(file, sound);
+  return true;
+}
+
+void SoundBufferLoader::serialize(const Decoded& sound, std::vector<char>& bytes) {
+  std::uint32_t format[2] = {sound.channelCount, sound.sampleRate};
+  std::uint64_t count = sound.samples.size();
+
+  bytes.resize(sizeof(format) + sizeof(count) + count * sizeof(sf::Int16));
+  std::memcpy(bytes.data(), format, sizeof(format));
+  std::memcpy(bytes.data() + sizeof(format), &count, sizeof(count));
+  if (count > 0)
+    std::memcpy(bytes.data() + sizeof(format) + sizeof(count), sound.samples.data(), count * sizeof(sf::Int16));
+}
+
+// Checks the layout of serialized samples, and finds them. The decoded cache aligns the data, so
+// the samples can be read in place
+static const sf::Int16* findSamples(const void* data, std::size_t size, std::uint32_t (&format)[2], std::uint64_t& count) {
+  if (size < sizeof(format) + sizeof(count))
+    return nullptr;
+
+  const char* bytes = static_cast<const char*>(data);
+  std::memcpy(format, bytes, sizeof(format));
+  std::memcpy(&count, bytes + sizeof(format), sizeof(count));
+  if (count > (size - sizeof(format) - sizeof(count)) / sizeof(sf::Int16) ||
+      size != sizeof(format) + sizeof(count) + count * sizeof(sf::Int16))
+    return nullptr;
+
+  return reinterpret_cast<const sf::Int16*>(bytes + sizeof(format) + sizeof(count));
+}
+
+bool SoundBufferLoader::deserialize(const void* data, std::size_t size, Decoded& sound) {
+  std::uint32_t format[2];
+  std::uint64_t count;
+  const sf::Int16* samples = findSamples(data, size, format, count);
+  if (!samples)
+    return false;
+
+  sound.channelCount = format[0];
+  sound.sampleRate = format[1];
+  sound.samples.assign(samples, samples + count);
+  return true;
+}
+
+bool SoundBufferLoader::finalizeSerialized(sf::SoundBuffer& sound, const void* data, std::size_t size) {
+  std::uint32_t format[2];
+  std::uint64_t count;
+  const sf::Int16* samples = findSamples(data, size, format, count);
+  return samples && sound.loadFromSamples(samples, count, format[0], format[1]);
+}
+
+bool FontLoader::decode(const std::string& filePath, Decoded& font) {
+  return readFile(filePath, font.bytes);
+}
+
+bool readFile(const std::string& filePath, std::vector<char>& data) {
+  std::ifstream file(filePath, std::ios::binary);
+  if (!file)
+    return false;
+
+  data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  return true;
+}
@@ -0,0 +1,328 @@
+/*
+DEPENDENCIES:
+sf::Texture
+sf::Image
+sf::SoundBuffer
+sf::InputSoundFile
+sf::Music
+sf::Font
+std::string_view
+TextureTier
+*/
+
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <SFML/Audio.hpp>
+
+#include "TextureTier.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+The loader policies used by ResourceCache. Each one describes, at compile time, how a single
+type of resource is read in:
+
+  Decoded          The CPU side form of the resource, filled in by decode()
+  RETAIN_DECODED   Whether the resource keeps reading from its decoded data after finalize(), in
+                   which case the cache holds on to the data for as long as the resource exists
+  DEFAULT_INVALID_PATH
+                   The file used as a fallback when another file can't be loaded
+  EXTENSIONS       The file extensions that will be picked up when pre loading a folder, without
+                   the dot (they are matched ignoring case, see FileScan.hpp)
+
+  load(resource, path)        Load the resource directly from a file (used for cache misses)
+  loadFromMemory(resource, data, size)
+                              Load the resource from a file's contents in memory (e.g. a ResourcePack)
+  decode(path, decoded)       Read the file into its decoded form. This must not touch any shared
+                              state, as it is called from worker threads
+  decodeFromMemory(data, size, decoded)
+                              As decode, but from a file's contents in memory. The memory stays valid
+                              for as long as the resource exists
+  finalize(resource, decoded) Create the resource from the decoded data. This is always called on
+                              the thread that owns the cache (and GL context)
+  getSize(resource)           The (approximate) memory used by the resource, for the cache budget
+  CACHE_DECODED               Whether decoded data is worth storing in a DecodedCache, in which case:
+  serialize(decoded, bytes)   Write the decoded data out in a form that deserialize can read back
+  deserialize(data, size, decoded)
+                              Read decoded data back from serialize's output (in a mapped file)
+  finalizeSerialized(resource, data, size)
+                              Optional; create the resource straight from serialize's output, so that
+                              a decoded cache entry is uploaded from its mapping without a copy
+  getDecodedSize(decoded)     The memory used by retained data (only for RETAIN_DECODED loaders)
+
+Optionally, a loader whose output depends on a runtime setting can also have:
+
+  getVariant()                The current setting, as a number. Decoded cache entries are kept
+                              separately for each variant, and ResourceCache::reloadStale() reloads
+                              the resources that were loaded with a different one
+
+A loader with RETAIN_DECODED can also have:
+
+  copyFromMemory(data, size, decoded)
+                              As decodeFromMemory, but for memory that doesn't outlive the call (a
+                              file that was only mapped to be hashed), so decoded has to own a copy.
+                              Without it, such files are decoded from the path instead
+
+A loader with getVariant() also takes the variant as an extra last argument to load, loadFromMemory,
+decode and decodeFromMemory. The cache reads the setting once for each file and passes it along, so
+that a file is always loaded with the variant it is recorded (and cached) under, even if the setting
+changes while it is being decoded.
+
+Any other type can be cached by writing a loader with the same members, for example:
+
+  ResourceCache<sf::Image, ImageLoader> imageCache;
+*/
+
+/**
+ * @brief Loader policy for sf::Texture. Files are decoded into an sf::Image (scaled down to the
+ * current resolution tier), which is uploaded to the graphics card in finalize.
+ */
+struct TextureLoader {
+  typedef sf::Image Decoded;
+
+  static constexpr bool RETAIN_DECODED = false;
+  static constexpr const char* DEFAULT_INVALID_PATH = "invalid.png";
+  static constexpr std::string_view EXTENSIONS[] = {"png", "jpg", "jpeg"};
+
+  /**
+   * @brief The resolution tier textures are loaded at, see ResourceManager::setTextureTier
+   */
+  static inline std::atomic<TextureTier> tier{TextureTier::Full};
+
+  static std::uint32_t getVariant() {
+    return static_cast<std::uint32_t>(tier.load());
+  }
+
+  static bool load(sf::Texture& texture, const std::string& filePath, std::uint32_t variant = getVariant()) {
+    // At full resolution the texture can be loaded straight from the file
+    if (static_cast<TextureTier>(variant) == TextureTier::Full)
+      return texture.loadFromFile(filePath);
+
+    sf::Image image;
+    return decode(filePath, image, variant) && texture.loadFromImage(image);
+  }
+
+  static bool loadFromMemory(sf::Texture& texture, const void* data, std::size_t size,
+                             std::uint32_t variant = getVariant()) {
+    if (static_cast<TextureTier>(variant) == TextureTier::Full)
+      return texture.loadFromMemory(data, size);
+
+    sf::Image image;
+    return decodeFromMemory(data, size, image, variant) && texture.loadFromImage(image);
+  }
+
+  static bool decode(const std::string& filePath, Decoded& image, std::uint32_t variant = getVariant()) {
+    if (!image.loadFromFile(filePath))
+      return false;
+
+    scaleToTier(image, static_cast<TextureTier>(variant));
+    return true;
+  }
+
+  static bool decodeFromMemory(const void* data, std::size_t size, Decoded& image,
+                               std::uint32_t variant = getVariant()) {
+    if (!image.loadFromMemory(data, size))
+      return false;
+
+    scaleToTier(image, static_cast<TextureTier>(variant));
+    return true;
+  }
+
+  static bool finalize(sf::Texture& texture, Decoded& image) {
+    return texture.loadFromImage(image);
+  }
+
+  static std::size_t getSize(const sf::Texture& texture) {
+    // Textures are stored as 8 bit RGBA
+    return static_cast<std::size_t>(texture.getSize().x) * texture.getSize().y * 4;
+  }
+
+  // Images are cached as their size followed by the raw pixels
+  static constexpr bool CACHE_DECODED = true;
+
+  static void serialize(const Decoded& image, std::vector<char>& bytes);
+
+  static bool deserialize(const void* data, std::size_t size, Decoded& image);
+
+  static bool finalizeSerialized(sf::Texture& texture, const void* data, std::size_t size);
+};
+
+/**
+ * @brief Loader policy for sf::SoundBuffer. Files are decoded into raw samples.
+ */
+struct SoundBufferLoader {
+  struct Decoded {
+    std::vector<sf::Int16> samples;
+    unsigned int channelCount = 0;
+    unsigned int sampleRate = 0;
+  };
+
+  static constexpr bool RETAIN_DECODED = false;
+  static constexpr const char* DEFAULT_INVALID_PATH = "invalid.wav";
+  static constexpr std::string_view EXTENSIONS[] = {"wav", "ogg", "flac"};
+
+  static bool load(sf::SoundBuffer& sound, const std::string& filePath) {
+    return sound.loadFromFile(filePath);
+  }
+
+  static bool loadFromMemory(sf::SoundBuffer& sound, const void* data, std::size_t size) {
+    return sound.loadFromMemory(data, size);
+  }
+
+  static bool decode(const std::string& filePath, Decoded& sound);
+
+  static bool decodeFromMemory(const void* data, std::size_t size, Decoded& sound);
+
+  static bool finalize(sf::SoundBuffer& sound, Decoded& decoded) {
+    return sound.loadFromSamples(decoded.samples.data(), decoded.samples.size(),
+                                 decoded.channelCount, decoded.sampleRate);
+  }
+
+  static std::size_t getSize(const sf::SoundBuffer& sound) {
+    return static_cast<std::size_t>(sound.getSampleCount()) * sizeof(sf::Int16);
+  }
+
+  // Sounds are cached as their format followed by the raw samples
+  static constexpr bool CACHE_DECODED = true;
+
+  static void serialize(const Decoded& sound, std::vector<char>& bytes);
+
+  static bool deserialize(const void* data, std::size_t size, Decoded& sound);
+
+  static bool finalizeSerialized(sf::SoundBuffer& sound, const void* data, std::size_t size);
+};
+
+/**
+ * @brief Loader policy for sf::Font. Files are read into memory, and since sf::Font reads from
+ * that memory for as long as it exists, the cache keeps it alive. Fonts decoded from memory that
+ * already stays valid (a ResourcePack) just point at it instead of copying it.
+ */
+struct FontLoader {
+  struct Decoded {
+    // The file contents, when they were read from a file
+    std::vector<char> bytes;
+
+    // Otherwise, the memory the font was decoded from
+    const void* data = nullptr;
+    std::size_t size = 0;
+  };
+
+  static constexpr bool RETAIN_DECODED = true;
+  static constexpr const char* DEFAULT_INVALID_PATH = "invalid.ttf";
+  static constexpr std::string_view EXTENSIONS[] = {"ttf", "otf"};
+
+  static bool load(sf::Font& font, const std::string& filePath) {
+    return font.loadFromFile(filePath);
+  }
+
+  static bool loadFromMemory(sf::Font& font, const void* data, std::size_t size) {
+    return font.loadFromMemory(data, size);
+  }
+
+  static bool decode(const std::string& filePath, Decoded& font);
+
+  static bool decodeFromMemory(const void* data, std::size_t size, Decoded& font) {
+    font.data = data;
+    font.size = size;
+    return true;
+  }
+
+  static bool copyFromMemory(const void* data, std::size_t size, Decoded& font) {
+    const char* bytes = static_cast<const char*>(data);
+    font.bytes.assign(bytes, bytes + size);
+    return true;
+  }
+
+  static bool finalize(sf::Font& font, Decoded& decoded) {
+    if (!decoded.bytes.empty())
+      return font.loadFromMemory(decoded.bytes.data(), decoded.bytes.size());
+
+    return font.loadFromMemory(decoded.data, decoded.size);
+  }
+
+  static std::size_t getSize(const sf::Font&) {
+    // SFML doesn't expose the size of the glyph pages, so only the file data is counted
+    return 0;
+  }
+
+  static std::size_t getDecodedSize(const Decoded& decoded) {
+    return decoded.bytes.size();
+  }
+
+  // Fonts aren't decoded up front, so there is nothing to gain from caching them
+  static constexpr bool CACHE_DECODED = false;
+};
+
+/**
+ * @brief Loader policy for sf::Music, used for sound files that are too large to decode up front
+ * (see ResourceManager::setStreamingThreshold). Opening a stream only reads the header of the file;
+ * the samples are read and decoded in chunks while it plays.
+ */
+struct MusicLoader {
+  struct Decoded {
+    // Either the file the music streams from
+    std::string path;
+
+    // Or the memory it streams from (which has to outlive the music)
+    const void* data = nullptr;
+    std::size_t size = 0;
+  };
+
+  // Music from memory keeps reading from it for as long as it is open
+  static constexpr bool RETAIN_DECODED = true;
+  static constexpr const char* DEFAULT_INVALID_PATH = "invalid.wav";
+  static constexpr std::string_view EXTENSIONS[] = {"wav", "ogg", "flac"};
+
+  static bool load(sf::Music& music, const std::string& filePath) {
+    return music.openFromFile(filePath);
+  }
+
+  static bool loadFromMemory(sf::Music& music, const void* data, std::size_t size) {
+    return music.openFromMemory(data, size);
+  }
+
+  static bool decode(const std::string& filePath, Decoded& music) {
+    // There is nothing to do up front; the file is opened when the music is created
+    music.path = filePath;
+    return true;
+  }
+
+  static bool decodeFromMemory(const void* data, std::size_t size, Decoded& music) {
+    music.data = data;
+    music.size = size;
+    return true;
+  }
+
+  static bool finalize(sf::Music& music, Decoded& decoded) {
+    if (decoded.data)
+      return music.openFromMemory(decoded.data, decoded.size);
+
+    return music.openFromFile(decoded.path);
+  }
+
+  static std::size_t getSize(const sf::Music&) {
+    // A stream only ever holds a few small buffers of samples
+    return 0;
+  }
+
+  static std::size_t getDecodedSize(const Decoded&) {
+    return 0;
+  }
+
+  static constexpr bool CACHE_DECODED = false;
+};
+
+/**
+ * @brief Read the entire contents of a file into memory. Safe to call from any thread.
+ * 
+ * @param filePath The file to read
+ * @param data The file contents will be stored here
+ * @return true The file was read successfully
+ * @return false The file couldn't be opened
+ */
+bool readFile(const std::string& filePath, std::vector<char>& data);
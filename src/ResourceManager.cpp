@@ -1,119 +1,174 @@
 #include "ResourceManager.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+#include <thread>
+
 
 
 /***************************
  *     DECLARATIONS 
  **************************/
 
-/*
-Since we are going to make sure the file we are reading in are pictures,
-we want an array of the possible file extensions
-*/
-const std::vector<std::string> ResourceManager::TEXTURE_EXTENSIONS = {"png", "jpg", "jpeg"};
-const std::vector<std::string> ResourceManager::SOUND_EXTENSIONS = {"wav"};
-const std::vector<std::string> ResourceManager::FONT_EXTENSIONS = {".ttf"};
+// The packs have to be defined before the caches, so that fonts reading from
+// them are destroyed before they are unmapped
+std::unique_ptr<ResourcePack> ResourceManager::m_pack = std::make_unique<ResourcePack>();
+std::vector<std::unique_ptr<ResourcePack>> ResourceManager::m_retiredPacks;
+
+// Here we initialize all of the caches as empty. The invalid paths default to
+// the name "invalid" + the proper extension (see ResourceLoaders.hpp)
+ResourceCache<sf::Texture, TextureLoader> ResourceManager::m_textures;
+ResourceCache<sf::SoundBuffer, SoundBufferLoader> ResourceManager::m_sounds;
+ResourceCache<sf::Music, MusicLoader> ResourceManager::m_music;
+ResourceCache<sf::Font, FontLoader> ResourceManager::m_fonts;
+
+TextureAtlas ResourceManager::m_atlas;
+
+DecodedCache ResourceManager::m_decodedCache;
+
+// Preloading is single threaded unless requested otherwise
+unsigned int ResourceManager::m_preLoadThreads = 1;
+
+// Nothing is streamed unless requested otherwise
+std::size_t ResourceManager::m_streamingThreshold = 0;
+
+// The background loader has to be defined after the caches, so that it is stopped
+// before they are destroyed
+AsyncLoader ResourceManager::m_asyncLoader;
 
-// Here we initialize all of the maps as empty
-std::map<std::string, sf::Texture*> ResourceManager::m_textureMap;
-std::map<std::string, sf::SoundBuffer*> ResourceManager::m_soundMap;
-std::map<std::string, sf::Font*> ResourceManager::m_fontMap;
+FileWatcher ResourceManager::m_watcher;
+sf::Time ResourceManager::m_hotReloadDelay = sf::milliseconds(200);
+std::vector<std::pair<std::string, bool>> ResourceManager::m_preLoadedFolders;
 
-// Set the default invalid paths, just the name "invalid" + the proper extension
-const std::string ResourceManager::DEFAULT_INVALID_TEXTURE = "invalid.png";
-const std::string ResourceManager::DEFAULT_INVALID_SOUND = "invalid.wav";
-const std::string ResourceManager::DEFAULT_INVALID_FONT = "invalid.ttf";
+ResourceManifest ResourceManager::m_manifest;
 
-std::string ResourceManager::m_invalidTexture = ResourceManager::DEFAULT_INVALID_TEXTURE;
-std::string ResourceManager::m_invalidSound = ResourceManager::DEFAULT_INVALID_SOUND;
-std::string ResourceManager::m_invalidFont = ResourceManager::DEFAULT_INVALID_FONT;
+// Fonts aren't warmed unless requested otherwise
+GlyphWarmup ResourceManager::m_fontWarmup;
+std::size_t ResourceManager::m_warmedGlyphBytes = 0;
+
+// The bundles hold handles into the caches, so they have to be defined after them
+std::map<std::string, ResourceManager::LoadedBundle, std::less<>> ResourceManager::m_loadedBundles;
+
+// Nothing is recorded or prefetched unless requested
+AccessTrace ResourceManager::m_trace;
+ResourceManager::Prefetch ResourceManager::m_prefetch;
 
 
 /***************************
  *    TEXTURE METHODS 
  **************************/
 
-sf::Texture* ResourceManager::getTexture(const std::string filePath) {
-
-  // Search through the map to see if there is already an entry
-  for (auto element: m_textureMap) {
-    //std::cout << element.first << " " << filePath << std::endl;
-
-    // We also want to check that the path is not invalid, as otherwise it would just be
-    // stuck as invalid, because it would technically have an entry in the map
-    if (element.first == filePath && element.first != m_invalidTexture)
-      return element.second;
-  }
+sf::Texture* ResourceManager::getTexture(std::string_view filePath) {
+  return m_textures.get(filePath);
+}
 
-  // If the code has made it to this point, it hasn't found a matching entry
-  // in the map. We use the new keyword because we want to store these variables
-  // outside of the stack
-  sf::Texture* texture = new sf::Texture();
-  
-  // If the texture doesn't load properly, we assign our invalid texture to it
-  if (!texture->loadFromFile(filePath)) {
-    texture->loadFromFile(m_invalidTexture);
-  }
+sf::Texture* ResourceManager::getTexture(const ResourceId& id) {
+  return m_textures.get(id);
+}
 
-  m_textureMap[filePath] = texture;
+ResourceHandle<sf::Texture> ResourceManager::getTextureHandle(std::string_view filePath) {
+  return m_textures.acquire(filePath);
+}
 
-  return m_textureMap[filePath];
+ResourceHandle<sf::Texture> ResourceManager::requestTexture(std::string_view filePath) {
+  return m_textures.request(filePath, m_asyncLoader);
 }
 
 int ResourceManager::getNumberOfTextures() {
-  return m_textureMap.size();
+  return m_textures.size();
 }
 
 void ResourceManager::preLoadTextures(const std::string folderPath, bool recurse) {
-  // We want to iterate through every file in the current folder
-  // If we are recursing, we use the recursive iterator
-  // The code in each loop is the same, the first just will have more files to
-  // process
-  if (recurse) {
-    for (auto& file: std::filesystem::recursive_directory_iterator(folderPath)) {
-      // We have to use a stringstream to get the path as a string here
-      std::stringstream ss;
-      ss << file;
-      //cout << ss.str() << endl;
-      // We want to make sure the file is in fact a picuture, so we check the extension
-      if (contains(TEXTURE_EXTENSIONS, ss.str().substr(ss.str().length() - 4, 3))) {
-        sf::Texture* texture = new sf::Texture();
-        // The substring nonsense in this next parameter is to remove extraneous quotes from ss
-        // Since this returns a boolean as to whether or not it completed, we can use our invalid tile
-        texture->loadFromFile(ss.str().substr(1, ss.str().length() - 2));
-        m_textureMap[ss.str().substr(1, ss.str().length() - 2)] = texture;
-        //out << getSize() << endl;
-      }
-    }
-  } else {
-    for (auto& file: std::filesystem::directory_iterator(folderPath)) {
-      // We have to use a stringstream to get the path as a string here
-      std::stringstream ss;
-      ss << file;      // We want to make sure the file is in fact a picuture, so we check the extension
-      if (contains(TEXTURE_EXTENSIONS, ss.str().substr(ss.str().length() - 3, 3))) {
-        sf::Texture* texture = new sf::Texture();
-        texture->loadFromFile(ss.str().substr(1, ss.str().length() - 2));
-        m_textureMap[ss.str().substr(1, ss.str().length() - 2)] = texture;
-        //cout << getSize() << endl;
-      }
-    }
+  m_textures.preLoad(folderPath, recurse, m_preLoadThreads);
+  addPreLoadedFolder(folderPath, recurse);
+}
 
-  }
+void ResourceManager::setInvalidTexturePath(const std::string filePath) {
+  m_textures.setInvalidPath(filePath);
+}
+
+std::string ResourceManager::getInvalidTexturePath() {
+  return m_textures.getInvalidPath();
 }
 
 void ResourceManager::clearTextures() {
+  m_textures.clear();
+}
 
-  // First we delete all of the pointers
-  for (auto element: m_textureMap) {
-    delete element.second;
+void ResourceManager::preLoadTextureAtlas(const std::string folderPath, bool recurse) {
+  // Listed (and read) from the pack when it has the folder, as with preLoadTextures
+  std::vector<std::string> files = m_textures.listFiles(folderPath, recurse);
+
+  // The images are decoded across the worker threads, as with preLoadTextures
+  std::vector<sf::Image> images(files.size());
+  std::vector<char> loaded(files.size());
+  runParallel(files.size(), m_preLoadThreads, [&](std::size_t i) {
+    const void* data;
+    std::size_t size;
+    if (m_pack->isOpen() && m_pack->find(files[i], data, size))
+      loaded[i] = TextureLoader::decodeFromMemory(data, size, images[i]);
+    else
+      loaded[i] = TextureLoader::decode(files[i], images[i]);
+  });
+
+  // The packing is tighter if the tallest images go in first. The sort is stable (and the
+  // files are sorted by path) so the layout is always the same for the same folder
+  std::vector<std::size_t> order(files.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+    return images[a].getSize().y > images[b].getSize().y;
+  });
+
+  // Anything that doesn't fit on a page is left out, and will be loaded as an ordinary
+  // texture by getTextureRegion
+  for (std::size_t i: order) {
+    if (loaded[i])
+      m_atlas.add(files[i], images[i]);
   }
 
-  // And now clear all of the entries
-  m_textureMap.clear();
+  // The images of a page that can't be uploaded are also loaded as ordinary textures instead,
+  // as their regions have no texture
+  m_atlas.upload();
 }
 
-std::string ResourceManager::getInvalidTexturePath() {
-  return m_invalidTexture;
+AtlasRegion ResourceManager::getTextureRegion(std::string_view filePath) {
+  AtlasRegion region = m_atlas.getRegion(filePath);
+  if (region.texture)
+    return region;
+
+  region.texture = getTexture(filePath);
+  region.rect = sf::IntRect(0, 0, region.texture->getSize().x, region.texture->getSize().y);
+  return region;
+}
+
+void ResourceManager::setAtlasPageSize(unsigned int pageSize) {
+  m_atlas.setPageSize(pageSize);
+}
+
+int ResourceManager::getNumberOfAtlasPages() {
+  return m_atlas.getNumberOfPages();
+}
+
+void ResourceManager::clearTextureAtlas() {
+  m_atlas.clear();
+}
+
+void ResourceManager::setTextureBudget(std::size_t bytes) {
+  m_textures.setBudget(bytes);
+}
+
+std::size_t ResourceManager::getTextureBytes() {
+  return m_textures.getBytes();
+}
+
+int ResourceManager::setTextureTier(TextureTier tier) {
+  TextureLoader::tier = tier;
+  return m_textures.reloadStale();
+}
+
+TextureTier ResourceManager::getTextureTier() {
+  return TextureLoader::tier;
 }
 
 
@@ -121,159 +176,154 @@ std::string ResourceManager::getInvalidTexturePath() {
  *    SOUND METHODS 
  **************************/
 
-sf::SoundBuffer* ResourceManager::getSoundBuffer(const std::string filePath) {
-  // Search through the map to see if there is already an entry
-  for (auto element: m_soundMap) {
-    //cout << element.first << " " << filePath << endl;
-    if (element.first == filePath && element.first != m_invalidSound)
-      return element.second;
-  }
-
-  sf::SoundBuffer* sound = new sf::SoundBuffer();
-  sound->loadFromFile(filePath);
+sf::SoundBuffer* ResourceManager::getSoundBuffer(std::string_view filePath) {
+  return m_sounds.get(filePath);
+}
 
-  // If the sound doesn't load properly, we assign our invalid sound to it
-  if (!sound->loadFromFile(filePath)) {
-    sound->loadFromFile(m_invalidSound);
-  }
+sf::SoundBuffer* ResourceManager::getSoundBuffer(const ResourceId& id) {
+  return m_sounds.get(id);
+}
 
-  m_soundMap[filePath] = sound;
+ResourceHandle<sf::SoundBuffer> ResourceManager::getSoundBufferHandle(std::string_view filePath) {
+  return m_sounds.acquire(filePath);
+}
 
-  return m_soundMap[filePath];
+ResourceHandle<sf::SoundBuffer> ResourceManager::requestSoundBuffer(std::string_view filePath) {
+  return m_sounds.request(filePath, m_asyncLoader);
 }
 
 int ResourceManager::getNumberOfSoundBuffers() {
-  return m_soundMap.size();
+  return m_sounds.size();
 }
 
 void ResourceManager::preLoadSoundBuffers(const std::string folderPath, bool recurse) {
-  // We want to iterate through every file in the current folder
-  // If we are recursing, we use the recursive iterator
-  // The code in each loop is the same, the first just will have more files to
-  // process
-
-  if (recurse) {
-    for (auto& file: std::filesystem::recursive_directory_iterator(folderPath)) {
-      std::stringstream ss;
-      ss << file;
-      //cout << ss.str() << endl;
-
-      if (contains(SOUND_EXTENSIONS, ss.str().substr(ss.str().length() - 4, 3))) {
-        sf::SoundBuffer* sound = new sf::SoundBuffer();
-        // The substring nonsense in this next parameter is to remove extraneous quotes from ss
-        sound->loadFromFile(ss.str().substr(1, ss.str().length() - 2));
-        m_soundMap[ss.str().substr(1, ss.str().length() - 2)] = sound;
-      }
-    }
-  } else {
-    for (auto& file: std::filesystem::directory_iterator(folderPath)) {
-      // We have to use a stringstream to get the path as a string here
-      std::stringstream ss;
-      ss << file;      // We want to make sure the file is in fact a sound, so we check the extension
-      if (contains(SOUND_EXTENSIONS, ss.str().substr(ss.str().length() - 3, 3))) {
-        sf::SoundBuffer* sound = new sf::SoundBuffer();
-        // The substring nonsense in this next parameter is to remove extraneous quotes from ss
-        sound->loadFromFile(ss.str().substr(1, ss.str().length() - 2));
-        m_soundMap[ss.str().substr(1, ss.str().length() - 2)] = sound;
-      }
-    }
-  }
+  preLoadSoundFiles(m_sounds.listFiles(folderPath, recurse));
+  addPreLoadedFolder(folderPath, recurse);
+}
+
+void ResourceManager::setInvalidSoundPath(const std::string filePath) {
+  m_sounds.setInvalidPath(filePath);
+}
+
+std::string ResourceManager::getInvalidSoundPath() {
+  return m_sounds.getInvalidPath();
 }
 
 void ResourceManager::clearSoundBuffers() {
+  m_sounds.clear();
+}
 
-  // First we delete all of the pointers
-  for (auto element: m_soundMap) {
-    delete element.second;
-  }
+void ResourceManager::setSoundBufferBudget(std::size_t bytes) {
+  m_sounds.setBudget(bytes);
+}
 
-  // And now clear all of the entries
-  m_soundMap.clear();
+std::size_t ResourceManager::getSoundBufferBytes() {
+  return m_sounds.getBytes();
 }
 
-std::string ResourceManager::getInvalidSoundPath() {
-  return m_invalidSound;
+sf::Music* ResourceManager::getMusic(std::string_view filePath) {
+  return m_music.get(filePath);
+}
+
+int ResourceManager::getNumberOfMusic() {
+  return m_music.size();
 }
 
+void ResourceManager::clearMusic() {
+  m_music.clear();
+  closeRetiredPacks();
+}
 
-/***************************
- *    FONT METHODS 
- **************************/
+void ResourceManager::setStreamingThreshold(std::size_t bytes) {
+  m_streamingThreshold = bytes;
+}
 
-sf::Font* ResourceManager::getFont(const std::string filePath) {
+std::size_t ResourceManager::getStreamingThreshold() {
+  return m_streamingThreshold;
+}
 
-  // Search through the map to see if there is already an entry
-  for (auto element: m_fontMap) {
-    //cout << element.first << " " << filePath << endl;
-    if (element.first == filePath && element.first != m_invalidFont)
-      return element.second;
-  }
 
-  sf::Font* font = new sf::Font();
-  font->loadFromFile(filePath);
+/***************************
+ *    FONT METHODS 
+ **************************/
 
-  // If the sound doesn't load properly, we assign our invalid sound to it
-  if (!font->loadFromFile(filePath)) {
-    font->loadFromFile(m_invalidFont);
-  }
+sf::Font* ResourceManager::getFont(std::string_view filePath) {
+  return m_fonts.get(filePath);
+}
 
-  m_fontMap[filePath] = font;
+sf::Font* ResourceManager::getFont(const ResourceId& id) {
+  return m_fonts.get(id);
+}
 
-  return m_fontMap[filePath];
+ResourceHandle<sf::Font> ResourceManager::getFontHandle(std::string_view filePath) {
+  return m_fonts.acquire(filePath);
+}
 
+ResourceHandle<sf::Font> ResourceManager::requestFont(std::string_view filePath) {
+  return m_fonts.request(filePath, m_asyncLoader);
 }
 
 int ResourceManager::getNumberOfFonts() {
-  return m_fontMap.size();
+  return m_fonts.size();
 }
 
 void ResourceManager::preLoadFonts(const std::string folderPath, bool recurse) {
-  // We want to iterate through every file in the current folder
-  // If we are recursing, we use the recursive iterator
-  // The code in each loop is the same, the first just will have more files to
-  // process
-
-  if (recurse) {
-    for (auto& file: std::filesystem::recursive_directory_iterator(folderPath)) {
-      std::stringstream ss;
-      ss << file;
-      //cout << ss.str() << endl;
-
-      if (contains(FONT_EXTENSIONS, ss.str().substr(ss.str().length() - 4, 3))) {
-        sf::Font* font = new sf::Font();
-        // The substring nonsense in this next parameter is to remove extraneous quotes from ss
-        font->loadFromFile(ss.str().substr(1, ss.str().length() - 2));
-        m_fontMap[ss.str().substr(1, ss.str().length() - 2)] = font;
-      }
-    }
-  } else {
-    for (auto& file: std::filesystem::directory_iterator(folderPath)) {
-      // We have to use a stringstream to get the path as a string here
-      std::stringstream ss;
-      ss << file;      // We want to make sure the file is in fact a font, so we check the extension
-      if (contains(FONT_EXTENSIONS, ss.str().substr(ss.str().length() - 3, 3))) {
-        sf::Font* font = new sf::Font();
-        // The substring nonsense in this next parameter is to remove extraneous quotes from ss
-        font->loadFromFile(ss.str().substr(1, ss.str().length() - 2));
-        m_fontMap[ss.str().substr(1, ss.str().length() - 2)] = font;
-      }
-    }
-  }
+  std::vector<std::string> files = m_fonts.listFiles(folderPath, recurse);
+  m_fonts.preLoad(files, m_preLoadThreads);
+  warmFonts(files);
+  addPreLoadedFolder(folderPath, recurse);
+}
+
+void ResourceManager::setInvalidFontPath(const std::string filePath) {
+  m_fonts.setInvalidPath(filePath);
 }
 
 std::string ResourceManager::getInvalidFontPath() {
-  return m_invalidFont;
+  return m_fonts.getInvalidPath();
 }
 
 void ResourceManager::clearFonts() {
+  m_fonts.clear();
+  closeRetiredPacks();
+}
 
-  // First we delete all of the pointers
-  for (auto element: m_fontMap) {
-    delete element.second;
-  }
+void ResourceManager::setFontBudget(std::size_t bytes) {
+  m_fonts.setBudget(bytes);
+}
 
-  // And now clear all of the entries
-  m_fontMap.clear();
+std::size_t ResourceManager::getFontBytes() {
+  return m_fonts.getBytes();
+}
+
+void ResourceManager::setFontWarmup(const GlyphWarmup& warmup) {
+  m_fontWarmup = warmup;
+}
+
+std::size_t ResourceManager::warmFont(std::string_view filePath, const GlyphWarmup& warmup) {
+  // Warming isn't a lookup by the game, so it stays out of the trace
+  const sf::Font& font = *m_fonts.get(filePath, false);
+
+  // Asking for the page sizes first makes SFML create the pages, so the difference is only
+  // what the glyphs themselves took
+  std::size_t before = getGlyphPageBytes(font, warmup.characterSizes);
+  std::size_t after = warmGlyphs(font, warmup);
+  m_warmedGlyphBytes += after - before;
+
+  return after;
+}
+
+std::size_t ResourceManager::getWarmedGlyphBytes() {
+  return m_warmedGlyphBytes;
+}
+
+void ResourceManager::warmFonts(const std::vector<std::string>& files) {
+  if (m_fontWarmup.isEmpty())
+    return;
+
+  // Rasterizing updates the glyph page textures, so unlike decoding it can't be spread over the
+  // preload threads
+  for (const std::string& file: files)
+    warmFont(file, m_fontWarmup);
 }
 
 
@@ -289,3 +339,407 @@ bool ResourceManager::contains(std::vector<std::string> vec, std::string str) {
   return false;
 }
 
+int ResourceManager::unloadUnused() {
+  int unloaded = m_textures.unloadUnused() + m_sounds.unloadUnused() + m_music.unloadUnused() + m_fonts.unloadUnused();
+  closeRetiredPacks();
+  return unloaded;
+}
+
+bool ResourceManager::mountPack(const std::string packPath) {
+  unmountPack();
+
+  if (!m_pack->open(packPath))
+    return false;
+
+  m_textures.setPack(m_pack.get());
+  m_sounds.setPack(m_pack.get());
+  m_music.setPack(m_pack.get());
+  m_fonts.setPack(m_pack.get());
+  return true;
+}
+
+void ResourceManager::unmountPack() {
+  m_textures.setPack(nullptr);
+  m_sounds.setPack(nullptr);
+  m_music.setPack(nullptr);
+  m_fonts.setPack(nullptr);
+
+  if (!m_pack->isOpen())
+    return;
+
+  // The invalid font and music may have come from the pack too, so they are loaded again without it
+  std::string invalidFont = m_fonts.getInvalidPath();
+  std::string invalidMusic = m_music.getInvalidPath();
+  m_fonts.setInvalidPath(invalidFont);
+  m_music.setInvalidPath(invalidMusic);
+
+  // Fonts and music read from the data they were loaded from for as long as they are loaded, so
+  // their pack can't be unmapped under them yet
+  if (m_fonts.size() > 0 || m_music.size() > 0) {
+    m_retiredPacks.push_back(std::move(m_pack));
+    m_pack = std::make_unique<ResourcePack>();
+  } else {
+    m_pack->close();
+  }
+}
+
+void ResourceManager::closeRetiredPacks() {
+  if (m_fonts.size() == 0 && m_music.size() == 0)
+    m_retiredPacks.clear();
+}
+
+bool ResourceManager::setDecodedCacheDirectory(const std::string directory) {
+  m_decodedCache.close();
+
+  bool opened = !directory.empty() && m_decodedCache.open(directory);
+  m_textures.setDecodedCache(opened ? &m_decodedCache : nullptr);
+  m_sounds.setDecodedCache(opened ? &m_decodedCache : nullptr);
+
+  return opened || directory.empty();
+}
+
+void ResourceManager::setDeduplication(bool deduplicate) {
+  m_textures.setDeduplicate(deduplicate);
+  m_sounds.setDeduplicate(deduplicate);
+  m_fonts.setDeduplicate(deduplicate);
+}
+
+std::size_t ResourceManager::getDeduplicatedBytes() {
+  return m_textures.getDeduplicatedBytes() + m_sounds.getDeduplicatedBytes() + m_music.getDeduplicatedBytes() + m_fonts.getDeduplicatedBytes();
+}
+
+void ResourceManager::setThreadSafe(bool threadSafe) {
+  m_textures.setThreadSafe(threadSafe);
+  m_sounds.setThreadSafe(threadSafe);
+  m_music.setThreadSafe(threadSafe);
+  m_fonts.setThreadSafe(threadSafe);
+}
+
+void ResourceManager::preLoadAll(const std::string folderPath, bool recurse) {
+  std::vector<std::string> textures, sounds, fonts;
+
+  // Only the files that are kept are copied into strings
+  auto classify = [&](const auto& extension) -> std::vector<std::string>* {
+    if (matchesExtension(extension, TextureLoader::EXTENSIONS))
+      return &textures;
+    if (matchesExtension(extension, SoundBufferLoader::EXTENSIONS))
+      return &sounds;
+    if (matchesExtension(extension, FontLoader::EXTENSIONS))
+      return &fonts;
+    return nullptr;
+  };
+
+  // As with the preLoad methods, the pack is used if it has anything in the folder
+  if (m_pack->isOpen()) {
+    scanPackedFiles(*m_pack, folderPath, recurse, [&](std::string_view path) {
+      if (std::vector<std::string>* files = classify(getPackedExtension(path)))
+        files->emplace_back(path);
+    });
+  }
+  if (textures.empty() && sounds.empty() && fonts.empty()) {
+    scanFiles(folderPath, recurse, [&](const std::filesystem::path& path) {
+      if (std::vector<std::string>* files = classify(path.extension()))
+        files->push_back(path.string());
+    });
+  }
+
+  std::sort(textures.begin(), textures.end());
+  std::sort(sounds.begin(), sounds.end());
+  std::sort(fonts.begin(), fonts.end());
+
+  m_textures.preLoad(std::move(textures), m_preLoadThreads);
+  preLoadSoundFiles(std::move(sounds));
+  m_fonts.preLoad(fonts, m_preLoadThreads);
+  warmFonts(fonts);
+  addPreLoadedFolder(folderPath, recurse);
+}
+
+void ResourceManager::setPreLoadThreadCount(unsigned int count) {
+  if (count == 0)
+    count = std::max(1u, std::thread::hardware_concurrency());
+
+  m_preLoadThreads = count;
+}
+
+unsigned int ResourceManager::getPreLoadThreadCount() {
+  return m_preLoadThreads;
+}
+
+int ResourceManager::pump(sf::Time budget) {
+  sf::Clock clock;
+  int finished = 0;
+
+  prefetchDue();
+
+  std::function<void()> finalizer;
+  while (m_asyncLoader.popFinished(finalizer)) {
+    finalizer();
+    finished++;
+
+    if (clock.getElapsedTime() >= budget)
+      break;
+  }
+
+  return finished;
+}
+
+int ResourceManager::getNumberOfPendingRequests() {
+  return m_asyncLoader.getNumberOfPendingJobs();
+}
+
+ResourceStats ResourceManager::snapshot(bool includeEntries) {
+  ResourceStats stats;
+
+  stats.caches.push_back(m_textures.getStats(includeEntries));
+  stats.caches.back().type = "textures";
+  stats.caches.push_back(m_sounds.getStats(includeEntries));
+  stats.caches.back().type = "sounds";
+  stats.caches.push_back(m_music.getStats(includeEntries));
+  stats.caches.back().type = "music";
+  stats.caches.push_back(m_fonts.getStats(includeEntries));
+  stats.caches.back().type = "fonts";
+
+  return stats;
+}
+
+bool ResourceManager::setHotReload(bool enabled, sf::Time settleDelay) {
+  m_watcher.close();
+  m_hotReloadDelay = settleDelay;
+
+  if (!enabled)
+    return true;
+
+  if (!m_watcher.open())
+    return false;
+
+  for (auto& folder: m_preLoadedFolders)
+    m_watcher.watch(folder.first, folder.second);
+
+  return true;
+}
+
+int ResourceManager::reloadChangedFiles() {
+  int reloaded = 0;
+
+  // A sound can be both decoded and streamed, so every cache gets to reload the path
+  auto delay = std::chrono::microseconds(m_hotReloadDelay.asMicroseconds());
+  for (const std::string& path: m_watcher.poll(delay)) {
+    reloaded += m_textures.reload(path);
+    reloaded += m_sounds.reload(path);
+    reloaded += m_music.reload(path);
+    reloaded += m_fonts.reload(path);
+  }
+
+  return reloaded;
+}
+
+bool ResourceManager::loadManifest(const std::string manifestPath) {
+  const void* data;
+  std::size_t size;
+  if (m_pack->isOpen() && m_pack->find(manifestPath, data, size))
+    return m_manifest.loadFromMemory(std::string_view(static_cast<const char*>(data), size));
+
+  return m_manifest.loadFromFile(manifestPath);
+}
+
+bool ResourceManager::loadBundle(const std::string name) {
+  const std::vector<ManifestItem>* items = m_manifest.getBundle(name);
+  if (!items)
+    return false;
+
+  auto [it, inserted] = m_loadedBundles.try_emplace(name);
+  if (inserted)
+    loadItems(*items, it->second);
+  return true;
+}
+
+int ResourceManager::unloadBundle(const std::string name) {
+  auto it = m_loadedBundles.find(name);
+  if (it == m_loadedBundles.end())
+    return 0;
+
+  // Taken out first, so that the bundle's own handles don't keep its files loaded
+  LoadedBundle bundle = std::move(it->second);
+  m_loadedBundles.erase(it);
+
+  return unloadItems(bundle);
+}
+
+bool ResourceManager::isBundleLoaded(const std::string name) {
+  return m_loadedBundles.find(name) != m_loadedBundles.end();
+}
+
+void ResourceManager::loadItems(const std::vector<ManifestItem>& items, LoadedBundle& bundle) {
+  // The items are sorted by priority, so each priority is a run of them, which is loaded
+  // before moving on to the next
+  std::size_t start = 0;
+  while (start < items.size()) {
+    std::vector<std::string> textures, sounds, music, fonts;
+
+    std::size_t end = start;
+    for (; end < items.size() && items[end].priority == items[start].priority; end++) {
+      const ManifestItem& item = items[end];
+
+      switch (item.type) {
+        case ResourceType::Texture:
+          textures.push_back(item.path);
+          break;
+        case ResourceType::Sound:
+          if (m_streamingThreshold > 0 && m_sounds.getFileSize(item.path) > m_streamingThreshold)
+            music.push_back(item.path);
+          else
+            sounds.push_back(item.path);
+          break;
+        case ResourceType::Music:
+          music.push_back(item.path);
+          break;
+        case ResourceType::Font:
+          fonts.push_back(item.path);
+          break;
+      }
+    }
+
+    loadBundleFiles(m_textures, textures, bundle.textures);
+    loadBundleFiles(m_sounds, sounds, bundle.sounds);
+    loadBundleFiles(m_music, music, bundle.music);
+    loadBundleFiles(m_fonts, fonts, bundle.fonts);
+    warmFonts(fonts);
+    start = end;
+  }
+}
+
+int ResourceManager::unloadItems(LoadedBundle& bundle) {
+  return unloadBundleFiles(m_textures, bundle.textures) + unloadBundleFiles(m_sounds, bundle.sounds) +
+         unloadBundleFiles(m_music, bundle.music) + unloadBundleFiles(m_fonts, bundle.fonts);
+}
+
+
+/***************************
+ *    TRACE METHODS 
+ **************************/
+
+void ResourceManager::startTrace() {
+  m_trace.start();
+  m_textures.setTrace(&m_trace, ResourceType::Texture);
+  m_sounds.setTrace(&m_trace, ResourceType::Sound);
+  m_music.setTrace(&m_trace, ResourceType::Music);
+  m_fonts.setTrace(&m_trace, ResourceType::Font);
+}
+
+bool ResourceManager::saveTrace(const std::string tracePath) {
+  if (!m_trace.isRecording())
+    return false;
+
+  m_trace.stop();
+  m_textures.setTrace(nullptr, ResourceType::Texture);
+  m_sounds.setTrace(nullptr, ResourceType::Sound);
+  m_music.setTrace(nullptr, ResourceType::Music);
+  m_fonts.setTrace(nullptr, ResourceType::Font);
+
+  // The memory is only known for the resources that are still loaded
+  const std::vector<TraceItem>& items = m_trace.getItems();
+  for (std::size_t i = 0; i < items.size(); i++) {
+    m_trace.setBytes(i, visitCache(items[i].type, [&](auto& cache) {
+      return cache.getBytes(items[i].path);
+    }));
+  }
+
+  return m_trace.saveToFile(tracePath);
+}
+
+bool ResourceManager::startPrefetch(const std::string tracePath, const PrefetchBudget& budget) {
+  m_prefetch.active = false;
+  if (!m_prefetch.trace.loadFromFile(tracePath))
+    return false;
+
+  m_prefetch.budget = budget;
+  m_prefetch.clock.restart();
+  m_prefetch.next = 0;
+  m_prefetch.bytes = 0;
+  m_prefetch.fileBytes = 0;
+  m_prefetch.queued = 0;
+  m_prefetch.active = true;
+
+  // Whatever was needed right away last time is queued now, rather than at the first pump
+  prefetchDue();
+  return true;
+}
+
+void ResourceManager::stopPrefetch() {
+  m_prefetch.active = false;
+}
+
+int ResourceManager::getNumberOfPrefetched() {
+  return m_prefetch.queued;
+}
+
+void ResourceManager::prefetchDue() {
+  if (!m_prefetch.active)
+    return;
+
+  const std::vector<TraceItem>& items = m_prefetch.trace.getItems();
+  const PrefetchBudget& budget = m_prefetch.budget;
+  float elapsed = m_prefetch.clock.getElapsedTime().asSeconds();
+  double due = (elapsed + budget.lookahead.asSeconds()) * 1000.0;
+
+  // The IO budget allows a second's worth of reads up front, and then keeps to the rate
+  double ioAllowed = budget.ioBytesPerSecond * (elapsed + 1.0);
+
+  while (m_prefetch.next < items.size() && items[m_prefetch.next].milliseconds <= due) {
+    const TraceItem& item = items[m_prefetch.next];
+    std::size_t fileSize = visitCache(item.type, [&](auto& cache) {
+      return cache.getFileSize(item.path);
+    });
+
+    // At least one file always goes through, so a file larger than a second's worth still loads
+    if (budget.ioBytesPerSecond > 0 && m_prefetch.fileBytes > 0 && m_prefetch.fileBytes + fileSize > ioAllowed)
+      break;
+    m_prefetch.next++;
+
+    // Files that are gone since the trace was saved are left to be found missing as usual
+    std::size_t bytes = item.bytes > 0 ? item.bytes : fileSize;
+    if (fileSize == 0 || (budget.memoryBytes > 0 && m_prefetch.bytes + bytes > budget.memoryBytes))
+      continue;
+
+    bool queued = visitCache(item.type, [&](auto& cache) {
+      return cache.prefetch(item.path, m_asyncLoader);
+    });
+    if (queued) {
+      m_prefetch.bytes += bytes;
+      m_prefetch.fileBytes += fileSize;
+      m_prefetch.queued++;
+    }
+  }
+
+  if (m_prefetch.next == items.size())
+    m_prefetch.active = false;
+}
+
+void ResourceManager::preLoadSoundFiles(std::vector<std::string> files) {
+  // Large files are only opened as streams, so they don't have to be decoded at all
+  std::vector<std::string> streamed;
+  if (m_streamingThreshold > 0) {
+    auto large = std::stable_partition(files.begin(), files.end(), [](const std::string& file) {
+      return m_sounds.getFileSize(file) <= m_streamingThreshold;
+    });
+    streamed.assign(std::make_move_iterator(large), std::make_move_iterator(files.end()));
+    files.erase(large, files.end());
+  }
+
+  m_sounds.preLoad(std::move(files), m_preLoadThreads);
+  m_music.preLoad(std::move(streamed), m_preLoadThreads);
+}
+
+int ResourceManager::forgetMissingFiles() {
+  return m_textures.forgetFailed() + m_sounds.forgetFailed() + m_music.forgetFailed() + m_fonts.forgetFailed();
+}
+
+void ResourceManager::addPreLoadedFolder(const std::string& folderPath, bool recurse) {
+  auto folder = std::make_pair(folderPath, recurse);
+  if (std::find(m_preLoadedFolders.begin(), m_preLoadedFolders.end(), folder) != m_preLoadedFolders.end())
+    return;
+
+  m_preLoadedFolders.push_back(folder);
+  if (m_watcher.isOpen())
+    m_watcher.watch(folderPath, recurse);
+}
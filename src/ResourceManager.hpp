@@ -23,20 +23,51 @@ SOFTWARE.
 
 DEPENDENCIES:
 std::string
-std::map
+std::string_view
+AccessTrace
 sf::Texture
 sf::SoundBuffer
+sf::Music
+sf::Font
 std::vector
-std::filesystem
-std::stringstream
+std::unordered_map
+std::unique_ptr
+GlyphWarmup
+ResourceCache
+ResourceId
+ResourceManifest
+ResourceStats
+TextureTier
 */
 
 #pragma once
 #include <SFML/Graphics.hpp>
 #include <SFML/Audio.hpp>
 
+#include "AccessTrace.hpp"
+#include "AsyncLoader.hpp"
+#include "DecodedCache.hpp"
+#include "FileWatcher.hpp"
+#include "GlyphWarmup.hpp"
+#include "ResourceCache.hpp"
+#include "ResourceHandle.hpp"
+#include "ResourceId.hpp"
+#include "ResourceLoaders.hpp"
+#include "ResourceManifest.hpp"
+#include "ResourcePack.hpp"
+#include "ResourceStats.hpp"
+#include "TextureAtlas.hpp"
+#include "TextureTier.hpp"
+
+#include <cstddef>
 #include <iostream>
-#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 /*
 
@@ -56,69 +87,266 @@ and a method that will allow for the user to both access and create entries
 fluidly.
 */
 
+class ResourceScope;
+
 class ResourceManager {
 
+  friend class ResourceScope;
+
 private:
   /**
-   * @brief This map will hold pointers to all of the textures necessary.
-   * The key for the map will be the path to the file, such that we can not only access
+   * @brief This cache will hold pointers to all of the textures necessary.
+   * The key for the cache will be the path to the file, such that we can not only access
    * the texture through this, but differentiate between similarly named files in 
    * different locations. It is defined as static such that no instance of the class 
-   * needs to be created.
+   * needs to be created. The invalid texture (and the extensions recognized when pre loading)
+   * are described by TextureLoader.
    */
-  static std::map<std::string, sf::Texture*> m_textureMap;
+  static ResourceCache<sf::Texture, TextureLoader> m_textures;
 
   /**
-   * @brief The map for storing sound buffer pointers. For more detail, see m_textureMap.
+   * @brief The cache for storing sound buffers. For more detail, see m_textures.
    */
-  static std::map<std::string, sf::SoundBuffer*> m_soundMap;
+  static ResourceCache<sf::SoundBuffer, SoundBufferLoader> m_sounds;
 
   /**
-   * @brief The map for storing font pointers. For more detail, see m_textureMap.
+   * @brief The cache of streamed sounds, for sound files above the streaming threshold.
    */
-  static std::map<std::string, sf::Font*> m_fontMap;
+  static ResourceCache<sf::Music, MusicLoader> m_music;
 
-  /*
-  We also want to be able to provide an invalid texture/sound/font if the actual file doesn't
-  exist. The default location for this file will be in the same directory as the actual
-  cpp files, but will be able to be set through a method below
-  */
-  const static std::string DEFAULT_INVALID_TEXTURE;
-  const static std::string DEFAULT_INVALID_SOUND;
-  const static std::string DEFAULT_INVALID_FONT;
+  /**
+   * @brief Sound files larger than this (in bytes) are streamed by preLoadSoundBuffers, see setStreamingThreshold.
+   */
+  static std::size_t m_streamingThreshold;
+
+  /**
+   * @brief The cache for storing fonts. For more detail, see m_textures.
+   */
+  static ResourceCache<sf::Font, FontLoader> m_fonts;
+
+  /**
+   * @brief The atlas that preLoadTextureAtlas packs textures into.
+   */
+  static TextureAtlas m_atlas;
+
+  /**
+   * @brief The pack that is currently mounted, see mountPack.
+   */
+  static std::unique_ptr<ResourcePack> m_pack;
+
+  /**
+   * @brief Packs that have been unmounted while fonts or music were loaded, which may still be
+   * reading from their mapping. They are closed once no fonts or music are loaded.
+   */
+  static std::vector<std::unique_ptr<ResourcePack>> m_retiredPacks;
+
+  /**
+   * @brief Close the retired packs, if no fonts or music are loaded anymore.
+   */
+  static void closeRetiredPacks();
+
+  /**
+   * @brief The on disk cache of decoded textures and sounds, see setDecodedCacheDirectory.
+   */
+  static DecodedCache m_decodedCache;
+
+  /**
+   * @brief The number of worker threads used to decode files in the preLoad methods.
+   * A value of 1 (the default) decodes everything on the calling thread.
+   */
+  static unsigned int m_preLoadThreads;
+
+  /**
+   * @brief The background loader used by the request methods. Finished loads sit here until pump() is called.
+   */
+  static AsyncLoader m_asyncLoader;
+
+  /**
+   * @brief Watches the preloaded folders while hot reloading is on, see setHotReload.
+   */
+  static FileWatcher m_watcher;
+
+  /**
+   * @brief How long a changed file has to be left alone before it is reloaded.
+   */
+  static sf::Time m_hotReloadDelay;
+
+  /**
+   * @brief Every folder (and whether it was recursed into) passed to the preLoad methods, so that
+   * they can all be watched when hot reloading is turned on.
+   */
+  static std::vector<std::pair<std::string, bool>> m_preLoadedFolders;
 
   /**
-   * @brief The current location of the texture that will be used if another texture isn't found.
-   * See m_invalidSound and m_invalidFont for similar entries.
+   * @brief Remember a preloaded folder, and watch it if hot reloading is on.
    */
-  static std::string m_invalidTexture;
+  static void addPreLoadedFolder(const std::string& folderPath, bool recurse);
+
+  /**
+   * @brief Preload sound files, streaming the ones above the streaming threshold.
+   */
+  static void preLoadSoundFiles(std::vector<std::string> files);
+
+  /**
+   * @brief The glyphs rasterized for preloaded fonts, see setFontWarmup.
+   */
+  static GlyphWarmup m_fontWarmup;
+
+  /**
+   * @brief The total that the glyph pages have grown by through warming, see getWarmedGlyphBytes.
+   */
+  static std::size_t m_warmedGlyphBytes;
+
+  /**
+   * @brief Warm the given (loaded) fonts with m_fontWarmup, if it isn't empty.
+   */
+  static void warmFonts(const std::vector<std::string>& files);
+
+  /**
+   * @brief The bundles that loadBundle can load, see loadManifest.
+   */
+  static ResourceManifest m_manifest;
+
+  /**
+   * @brief The files of one type that a loaded bundle (or a ResourceScope) holds, and the handles that
+   * keep them loaded, by path. Only the files that weren't loaded before a bundle (or scope) took
+   * them are unloaded with it (see ResourceCache::markGrouped), since the game may still be using the
+   * others through plain pointers.
+   */
+  template<typename T>
+  struct BundleFiles {
+    std::unordered_map<std::string, ResourceHandle<T>, PathHash, std::equal_to<>> handles;
+  };
+
+  struct LoadedBundle {
+    BundleFiles<sf::Texture> textures;
+    BundleFiles<sf::SoundBuffer> sounds;
+    BundleFiles<sf::Music> music;
+    BundleFiles<sf::Font> fonts;
+  };
+
   /**
-   * @brief The current location of the sound that will be used if another sound isn't found.
-   * See m_invalidTexture and m_invalidFont for similar entries.
+   * @brief The bundles that are currently loaded, by name.
    */
-  static std::string m_invalidSound;
+  static std::map<std::string, LoadedBundle, std::less<>> m_loadedBundles;
+
+  /**
+   * @brief Load a file (if it hasn't been already) and take a handle to it, unless the bundle holds
+   * one already. Bundles don't add their files to the trace, as only the game's own lookups should be.
+   */
+  template<typename T, typename Loader>
+  static T* holdFile(ResourceCache<T, Loader>& cache, std::string_view path, BundleFiles<T>& files, bool record = true) {
+    auto it = files.handles.find(path);
+    if (it == files.handles.end()) {
+      bool existed = cache.contains(path);
+      it = files.handles.emplace(std::string(path), cache.acquire(path, record)).first;
+      if (!existed)
+        cache.markGrouped(path);
+    }
+    return it->second.get();
+  }
+
+  /**
+   * @brief Preload the files of one type (and priority) of a bundle, and take handles to them. The
+   * handles are taken as the files are loaded, so that a budget can't evict the bundle's own files
+   * while the rest of them are loading.
+   */
+  template<typename T, typename Loader>
+  static void loadBundleFiles(ResourceCache<T, Loader>& cache, const std::vector<std::string>& paths, BundleFiles<T>& files) {
+    std::vector<bool> existed(paths.size());
+    for (std::size_t i = 0; i < paths.size(); i++)
+      existed[i] = cache.contains(paths[i]);
+
+    std::vector<ResourceHandle<T>> handles;
+    cache.preLoad(paths, m_preLoadThreads, &handles);
+
+    for (std::size_t i = 0; i < paths.size(); i++) {
+      // Files another thread was still loading are waited for here instead
+      if (handles[i] && files.handles.find(paths[i]) == files.handles.end()) {
+        files.handles.emplace(paths[i], std::move(handles[i]));
+        if (!existed[i])
+          cache.markGrouped(paths[i]);
+      } else {
+        holdFile(cache, paths[i], files, false);
+      }
+    }
+  }
+
+  /**
+   * @brief Drop the handles of a bundle's files of one type, and unload the ones that were loaded for
+   * a bundle or scope and that nothing else holds (all under one lock).
+   */
+  template<typename T, typename Loader>
+  static int unloadBundleFiles(ResourceCache<T, Loader>& cache, BundleFiles<T>& files) {
+    std::vector<std::string> paths;
+    paths.reserve(files.handles.size());
+    for (auto& element: files.handles)
+      paths.push_back(element.first);
+
+    files.handles.clear();
+    return cache.unload(paths, true);
+  }
+
   /**
-   * @brief The current location of the font that will be used if another font isn't found.
-   * See m_invalidTexture and m_invalidSound for similar entries.
+   * @brief Load the items of a bundle into the given bundle's files, see loadBundle
    */
-  static std::string m_invalidFont;
+  static void loadItems(const std::vector<ManifestItem>& items, LoadedBundle& bundle);
 
   /**
-   * @brief A list of extensions that will be recognized as textures when pre loading a folder.
-   * Currently contains: png, jpg, jpeg
+   * @brief Drop all of a bundle's handles, and unload the files it loaded that nothing else holds
    */
-  const static std::vector<std::string> TEXTURE_EXTENSIONS;
+  static int unloadItems(LoadedBundle& bundle);
+
   /**
-   * @brief A list of extensions that will be recognized as sounds when pre loading a folder.
-   * Currently contains: wav
+   * @brief The trace that first lookups are recorded into, see startTrace.
    */
-  const static std::vector<std::string> SOUND_EXTENSIONS;
+  static AccessTrace m_trace;
+
   /**
-   * @brief A list of extensions that will be recognized as fonts when pre loading a folder.
-   * Currently contains: ttf
+   * @brief The trace being replayed by the prefetcher, and how far along it is.
    */
-  const static std::vector<std::string> FONT_EXTENSIONS;
+  struct Prefetch {
+    AccessTrace trace;
+    PrefetchBudget budget;
+    sf::Clock clock;
+    bool active = false;
 
+    /**
+     * @brief The next item to look at
+     */
+    std::size_t next = 0;
+
+    /**
+     * @brief The totals that are checked against the budget, and the number of files queued
+     */
+    std::size_t bytes = 0;
+    std::size_t fileBytes = 0;
+    int queued = 0;
+  };
+
+  static Prefetch m_prefetch;
+
+  /**
+   * @brief Queue the items of the prefetch trace that are due, as far as the budget allows
+   */
+  static void prefetchDue();
+
+  /**
+   * @brief Call a function with the cache that holds the given type of resource
+   */
+  template<typename Function>
+  static auto visitCache(ResourceType type, Function function) {
+    switch (type) {
+      case ResourceType::Texture:
+        return function(m_textures);
+      case ResourceType::Sound:
+        return function(m_sounds);
+      case ResourceType::Music:
+        return function(m_music);
+      default:
+        return function(m_fonts);
+    }
+  }
 
 public:
 
@@ -134,17 +362,47 @@ public:
    * @param filePath The (relative to project folder or absolute) location of the texture file
    * @return sf::Texture* A pointer to the texture at the given file path
    */
-  static sf::Texture* getTexture(const std::string filePath);
+  static sf::Texture* getTexture(std::string_view filePath);
+
+  /**
+   * @brief Get the texture with the given ID, as with getTexture(filePath). A loaded texture is found by the
+   * ID's hash alone, so with RES_ID no string is built or hashed at runtime.
+   * 
+   * @param id The ID of the texture, eg. RES_ID("path/to/file")
+   * @return sf::Texture* A pointer to the texture
+   */
+  static sf::Texture* getTexture(const ResourceId& id);
+
+  /**
+   * @brief Get a counted handle to the Texture at the given file path, loading it if need be (as with
+   * getTexture). Handles are cheap to copy, and the texture won't be evicted, unloaded or cleared for as
+   * long as a handle to it exists.
+   * 
+   * @param filePath The (relative to project folder or absolute) location of the texture file
+   * @return ResourceHandle<sf::Texture> A handle to the texture at the given file path
+   */
+  static ResourceHandle<sf::Texture> getTextureHandle(std::string_view filePath);
+
+  /**
+   * @brief Request the Texture at the given file path without blocking. If the texture hasn't been
+   * loaded yet, the file is read in the background, and the returned handle will point to the
+   * invalid texture until pump() has finished it. getTexture for this path in the meantime loads
+   * the texture right away instead.
+   * 
+   * @param filePath The (relative to project folder or absolute) location of the texture file
+   * @return ResourceHandle<sf::Texture> A handle that follows the texture entry for the path
+   */
+  static ResourceHandle<sf::Texture> requestTexture(std::string_view filePath);
 
   /**
-   * @brief Returns the size of the m_textureMap object
+   * @brief Returns the size of the m_textures cache
    * 
    * @return int The number of texture entries loaded in the resource manager
    */
   static int getNumberOfTextures();
 
   /**
-   * @brief Load all of the files in a given folder (whose file extensions appear in TEXTURE_EXTENSIONS)
+   * @brief Load all of the files in a given folder (whose file extensions appear in TextureLoader::EXTENSIONS)
    * into the texture map.
    * 
    * @param folderPath The The (relative to project folder or absolute) location of the folder where textures
@@ -175,10 +433,89 @@ public:
   static std::string getInvalidTexturePath();
 
   /**
-   * @brief Delete all of the pointers held in m_textureMap and clear the respective entries
+   * @brief Delete all of the pointers held in m_textures and clear the respective entries.
+   * Textures that are still held by a ResourceHandle are kept.
    */
   static void clearTextures();
 
+  /**
+   * @brief Set the maximum amount of memory the textures should use (width * height * 4 bytes each).
+   * When a new texture goes over this, the least recently used textures are deleted, so any
+   * pointers to those textures become invalid.
+   * 
+   * @param bytes The budget in bytes. 0 (the default) means no limit.
+   */
+  static void setTextureBudget(std::size_t bytes);
+
+  /**
+   * @brief Get the amount of memory used by the loaded textures
+   * 
+   * @return std::size_t The memory in bytes
+   */
+  static std::size_t getTextureBytes();
+
+  /**
+   * @brief Set the resolution textures are loaded at, eg. Half or Quarter to save memory on smaller
+   * machines. The textures that are already loaded at another tier are loaded again (in place, so
+   * pointers to them stay valid), and the rest are left alone. The texture atlas isn't rebuilt.
+   * 
+   * Textures really are smaller at lower tiers, so texture rects have to be divided by
+   * getTierDivisor(getTextureTier()). The tier should be changed between loads, since textures that
+   * are loading in the background at the time keep the old tier.
+   * 
+   * @param tier The new tier. Default is Full.
+   * @return int The number of textures that were loaded again
+   */
+  static int setTextureTier(TextureTier tier);
+
+  /**
+   * @brief Get the resolution textures are loaded at
+   * 
+   * @return TextureTier The current tier
+   */
+  static TextureTier getTextureTier();
+
+  /**
+   * @brief Load all of the textures in a given folder (as with preLoadTextures), but pack them into a few
+   * large atlas pages instead of creating a texture for each file, so that sprites from the same folder
+   * don't need a texture bind each. Use getTextureRegion to find them afterwards. Images that are larger
+   * than a page are left to be loaded as ordinary textures.
+   * 
+   * @param folderPath The (relative to project folder or absolute) location of the folder where textures
+   * are to be loaded from
+   * @param recurse Whether or not the manager should search for files recursively i.e. below the given folder.
+   * Default is true
+   */
+  static void preLoadTextureAtlas(const std::string folderPath, bool recurse = true);
+
+  /**
+   * @brief Get the texture and area of it that holds the image at the given path. For images that were
+   * packed by preLoadTextureAtlas this is an atlas page; otherwise it is the whole texture from getTexture.
+   * 
+   * @param filePath The (relative to project folder or absolute) location of the texture file
+   * @return AtlasRegion The texture and the rectangle to use for it (e.g. with sf::Sprite::setTextureRect)
+   */
+  static AtlasRegion getTextureRegion(std::string_view filePath);
+
+  /**
+   * @brief Set the width and height of the atlas pages created from now on. Default is 2048.
+   * 
+   * @param pageSize The page size in pixels
+   */
+  static void setAtlasPageSize(unsigned int pageSize);
+
+  /**
+   * @brief Returns the number of pages in the texture atlas
+   * 
+   * @return int The number of atlas pages
+   */
+  static int getNumberOfAtlasPages();
+
+  /**
+   * @brief Delete all of the atlas pages. Any regions from getTextureRegion become invalid.
+   */
+  static void clearTextureAtlas();
+
   /***************************
    *    SOUND METHODS 
    **************************/
@@ -191,18 +528,46 @@ public:
    * @param filePath The (relative to project folder or absolute) location of the sound file
    * @return sf::SoundBuffer* A pointer to the sound at the given file path
    */
-  static sf::SoundBuffer* getSoundBuffer(const std::string filePath);
+  static sf::SoundBuffer* getSoundBuffer(std::string_view filePath);
 
   /**
-   * @brief Returns the size of the m_soundMap object
+   * @brief Get the sound buffer with the given ID, as with getSoundBuffer(filePath). A loaded sound buffer is found by the
+   * ID's hash alone, so with RES_ID no string is built or hashed at runtime.
+   * 
+   * @param id The ID of the sound buffer, eg. RES_ID("path/to/file")
+   * @return sf::SoundBuffer* A pointer to the sound buffer
+   */
+  static sf::SoundBuffer* getSoundBuffer(const ResourceId& id);
+
+  /**
+   * @brief Get a counted handle to the SoundBuffer at the given file path, loading it if need be (as with
+   * getSoundBuffer). Handles are cheap to copy, and the sound won't be evicted, unloaded or cleared for as
+   * long as a handle to it exists.
+   * 
+   * @param filePath The (relative to project folder or absolute) location of the sound file
+   * @return ResourceHandle<sf::SoundBuffer> A handle to the sound at the given file path
+   */
+  static ResourceHandle<sf::SoundBuffer> getSoundBufferHandle(std::string_view filePath);
+
+  /**
+   * @brief Request the SoundBuffer at the given file path without blocking. For more detail, see requestTexture.
+   * 
+   * @param filePath The (relative to project folder or absolute) location of the sound file
+   * @return ResourceHandle<sf::SoundBuffer> A handle that follows the sound entry for the path
+   */
+  static ResourceHandle<sf::SoundBuffer> requestSoundBuffer(std::string_view filePath);
+
+  /**
+   * @brief Returns the size of the m_sounds cache
    * 
    * @return int The number of sound entries loaded in the resource manager
    */
   static int getNumberOfSoundBuffers();
 
   /**
-   * @brief Load all of the files in a given folder (whose file extensions appear in SOUND_EXTENSIONS)
-   * into the sound map.
+   * @brief Load all of the files in a given folder (whose file extensions appear in SoundBufferLoader::EXTENSIONS)
+   * into the sound map. Files larger than the streaming threshold are opened as streams (see getMusic)
+   * instead of being decoded.
    * 
    * @param folderPath The The (relative to project folder or absolute) location of the folder where sounds
    * are to be loaded from
@@ -227,11 +592,67 @@ public:
   static std::string getInvalidSoundPath();
 
   /**
-   * @brief Delete all of the pointers held in m_soundMap and clear the respective entries
+   * @brief Delete all of the pointers held in m_sounds and clear the respective entries.
+   * Sounds that are still held by a ResourceHandle are kept.
    */
   static void clearSoundBuffers();
 
 
+  /**
+   * @brief Set the maximum amount of memory the sounds should use (2 bytes per sample).
+   * For more detail, see setTextureBudget.
+   * 
+   * @param bytes The budget in bytes. 0 (the default) means no limit.
+   */
+  static void setSoundBufferBudget(std::size_t bytes);
+
+  /**
+   * @brief Get the amount of memory used by the loaded sounds
+   * 
+   * @return std::size_t The memory in bytes
+   */
+  static std::size_t getSoundBufferBytes();
+
+  /**
+   * @brief Get the Music (a sound that is streamed from its file in chunks while it plays, rather than
+   * decoded up front) at the given file path, opening it if it hasn't been already. Since every caller
+   * gets the same object, they also share its playing position.
+   * 
+   * @param filePath The (relative to project folder or absolute) location of the sound file
+   * @return sf::Music* A pointer to the music at the given file path
+   */
+  static sf::Music* getMusic(std::string_view filePath);
+
+  /**
+   * @brief Returns the size of the m_music cache
+   * 
+   * @return int The number of streamed sounds that have been opened
+   */
+  static int getNumberOfMusic();
+
+  /**
+   * @brief Close all of the streamed sounds and clear the respective entries.
+   */
+  static void clearMusic();
+
+  /**
+   * @brief Set the file size above which preLoadSoundBuffers opens a sound as a stream (see getMusic)
+   * instead of decoding all of its samples into memory. Long music and ambience tracks are best
+   * streamed, while short effects should stay fully decoded. getSoundBuffer is unaffected, and
+   * always decodes the whole file.
+   * 
+   * @param bytes The threshold in bytes (of the file, not the decoded samples). 0 (the default)
+   * decodes every file.
+   */
+  static void setStreamingThreshold(std::size_t bytes);
+
+  /**
+   * @brief Get the file size above which preLoadSoundBuffers streams sounds
+   * 
+   * @return std::size_t The threshold in bytes, or 0 if nothing is streamed
+   */
+  static std::size_t getStreamingThreshold();
+
   /***************************
    *    FONT METHODS 
    **************************/
@@ -244,17 +665,44 @@ public:
    * @param filePath The (relative to project folder or absolute) location of the font file
    * @return sf::Font* A pointer to the font at the given file path
    */
-  static sf::Font* getFont(const std::string filePath);
+  static sf::Font* getFont(std::string_view filePath);
+
+  /**
+   * @brief Get the font with the given ID, as with getFont(filePath). A loaded font is found by the
+   * ID's hash alone, so with RES_ID no string is built or hashed at runtime.
+   * 
+   * @param id The ID of the font, eg. RES_ID("path/to/file")
+   * @return sf::Font* A pointer to the font
+   */
+  static sf::Font* getFont(const ResourceId& id);
+
+  /**
+   * @brief Get a counted handle to the Font at the given file path, loading it if need be (as with
+   * getFont). Handles are cheap to copy, and the font won't be evicted, unloaded or cleared for as
+   * long as a handle to it exists.
+   * 
+   * @param filePath The (relative to project folder or absolute) location of the font file
+   * @return ResourceHandle<sf::Font> A handle to the font at the given file path
+   */
+  static ResourceHandle<sf::Font> getFontHandle(std::string_view filePath);
 
   /**
-   * @brief Returns the size of the m_fontMap object
+   * @brief Request the Font at the given file path without blocking. For more detail, see requestTexture.
+   * 
+   * @param filePath The (relative to project folder or absolute) location of the font file
+   * @return ResourceHandle<sf::Font> A handle that follows the font entry for the path
+   */
+  static ResourceHandle<sf::Font> requestFont(std::string_view filePath);
+
+  /**
+   * @brief Returns the size of the m_fonts cache
    * 
    * @return int The number of font entries loaded in the resource manager
    */
   static int getNumberOfFonts();
 
   /**
-   * @brief Load all of the files in a given folder (whose file extensions appear in FONT_EXTENSIONS)
+   * @brief Load all of the files in a given folder (whose file extensions appear in FontLoader::EXTENSIONS)
    * into the sound map.
    * 
    * @param folderPath The The (relative to project folder or absolute) location of the folder where fonts
@@ -280,11 +728,55 @@ public:
   static std::string getInvalidFontPath();
   
   /**
-   * @brief Delete all of the pointers held in m_fontMap and clear the respective entries
+   * @brief Delete all of the pointers held in m_fonts and clear the respective entries.
+   * Fonts that are still held by a ResourceHandle are kept.
    */
   static void clearFonts();
 
 
+  /**
+   * @brief Set the maximum amount of memory the fonts should use. Only the file data of fonts that
+   * were pre loaded or requested is counted, as the size of the glyph pages isn't known.
+   * For more detail, see setTextureBudget.
+   * 
+   * @param bytes The budget in bytes. 0 (the default) means no limit.
+   */
+  static void setFontBudget(std::size_t bytes);
+
+  /**
+   * @brief Get the amount of memory used by the loaded fonts
+   * 
+   * @return std::size_t The memory in bytes
+   */
+  static std::size_t getFontBytes();
+
+  /**
+   * @brief Set the glyphs that are rasterized for each font that preLoadFonts, preLoadAll and loadBundle
+   * go through, so that drawing text with them doesn't hitch the first time (see GlyphWarmup.hpp).
+   * Other fonts can be warmed with warmFont.
+   * 
+   * @param warmup The character sizes and characters, or an empty warmup (the default) to not warm fonts
+   */
+  static void setFontWarmup(const GlyphWarmup& warmup);
+
+  /**
+   * @brief Rasterize glyphs of the font at the given path up front, loading the font if need be.
+   * This has to be called from the thread that owns the GL context, as it updates the glyph pages.
+   * 
+   * @param filePath The (relative to project folder or absolute) location of the font file
+   * @param warmup The character sizes and characters to rasterize
+   * @return std::size_t The memory held by the font's glyph pages for those sizes afterwards, in bytes
+   */
+  static std::size_t warmFont(std::string_view filePath, const GlyphWarmup& warmup);
+
+  /**
+   * @brief Get the memory that warming has committed to glyph pages, ie. how much the pages of every
+   * warmed font (for the warmed sizes) have grown by in total. Not counted against the font budget.
+   * 
+   * @return std::size_t The memory in bytes
+   */
+  static std::size_t getWarmedGlyphBytes();
+
   /************************
    *        MISC
    ************************/
@@ -298,4 +790,254 @@ public:
    * @return false The string is not found in the vector
    */
   static bool contains(std::vector<std::string> vec, std::string str);
+
+  /**
+   * @brief Delete every texture, sound and font that isn't held by a ResourceHandle, e.g. between
+   * levels. Raw pointers returned by getTexture etc. aren't counted, so they shouldn't be kept across this.
+   * 
+   * @return int The number of resources that were unloaded
+   */
+  static int unloadUnused();
+
+  /**
+   * @brief Memory map a pack file (see ResourcePack.hpp and tools/PackBuilder.cpp), so that every
+   * file in it is loaded straight from memory instead of being opened on its own. Preloading a folder
+   * that is in the pack also lists the pack instead of scanning the folder. Files that aren't in the
+   * pack are still loaded from the filesystem.
+   * 
+   * @param packPath The location of the pack file
+   * @return true The pack was mounted
+   * @return false The pack couldn't be opened; nothing is mounted
+   */
+  static bool mountPack(const std::string packPath);
+
+  /**
+   * @brief Unmount the current pack. This shouldn't be called while requests are pending. Fonts and
+   * music loaded from the pack keep reading from its memory, so while any are loaded the pack stays
+   * mapped (but is no longer used for new files); it is closed once they have all been unloaded.
+   */
+  static void unmountPack();
+
+  /**
+   * @brief Keep the decoded pixels of textures and samples of sounds in the given directory, keyed by the
+   * path, size and modification time of each file. On later runs, files that haven't changed are read
+   * straight from there instead of being decoded again; files that have changed are decoded and their
+   * entries rewritten.
+   * 
+   * @param directory The directory to keep the decoded files in. An empty string turns the cache off.
+   * @return true The directory can be used (or the cache was turned off)
+   * @return false The directory couldn't be created; the cache is off
+   */
+  static bool setDecodedCacheDirectory(const std::string directory);
+
+  /**
+   * @brief Set whether files with identical contents (under different paths) should share a single
+   * resource. When on, the contents of each file are hashed as it is loaded, and a file that matches
+   * one that is already loaded returns the same pointer instead of being decoded again. Only affects
+   * files loaded afterwards. Streamed music is left out: a shared sf::Music would have a single
+   * playing position for every path, and hashing would read the whole file up front.
+   * 
+   * @param deduplicate Whether to deduplicate textures, sounds and fonts
+   */
+  static void setDeduplication(bool deduplicate);
+
+  /**
+   * @brief Get the memory that deduplication has saved, ie. the memory that the duplicate files would
+   * have used if they had been loaded separately.
+   * 
+   * @return std::size_t The memory saved across every type, in bytes
+   */
+  static std::size_t getDeduplicatedBytes();
+
+  /**
+   * @brief Set whether the get methods can be called from several threads at once. Hits then only
+   * take a per-thread lock, and when several threads miss the same file at once, it is loaded once
+   * by the first of them while the others wait. Configuration (the setters here, mounting packs,
+   * hot reloading) and finishing background requests still belong to the thread that owns the
+   * manager, and should be done before (or after) the other threads use it.
+   *
+   * Textures loaded on other threads are created in that thread's own (shared) OpenGL context,
+   * which SFML makes when it is first needed.
+   * 
+   * @param threadSafe Whether the caches should lock around every access
+   */
+  static void setThreadSafe(bool threadSafe);
+
+  /**
+   * @brief Load all of the textures, sounds and fonts in a folder, as preLoadTextures, preLoadSoundBuffers
+   * and preLoadFonts would, but walking the folder (or the mounted pack) only once. Each file is sorted
+   * into its type by its extension (ignoring case).
+   * 
+   * @param folderPath The (relative to project folder or absolute) location of the folder
+   * @param recurse Whether or not to search for files below the given folder. Default is true
+   */
+  static void preLoadAll(const std::string folderPath, bool recurse = true);
+
+  /**
+   * @brief Set the number of worker threads that the preLoad methods use to decode files.
+   * Workers only ever decode into CPU side objects (sf::Image, raw samples, font bytes); the
+   * final sf::Texture upload always happens on the calling thread, which should be the one that
+   * owns the GL context. The resulting maps are the same regardless of the thread count.
+   * 
+   * @param count The number of threads to use. 0 will use std::thread::hardware_concurrency().
+   */
+  static void setPreLoadThreadCount(unsigned int count);
+
+  /**
+   * @brief Get the number of worker threads used by the preLoad methods.
+   * 
+   * @return unsigned int The current number of preload threads
+   */
+  static unsigned int getPreLoadThreadCount();
+
+  /**
+   * @brief Finish the requests whose files have been read in the background, swapping the placeholders
+   * for the real resources. This should be called once per frame from the thread that owns the
+   * GL context. Finished requests are processed until the time budget is used up, though at least
+   * one is always processed so that loading keeps moving.
+   * 
+   * @param budget The amount of time that can be spent finishing requests
+   * @return int The number of requests that were finished
+   */
+  static int pump(sf::Time budget);
+
+  /**
+   * @brief Get the number of requests that haven't been finished by pump() yet
+   * 
+   * @return int The number of pending requests
+   */
+  static int getNumberOfPendingRequests();
+
+  /**
+   * @brief Take a copy of the counters for every type of resource: hits, misses, fallbacks to the
+   * invalid file, load time and memory, and optionally the load time, memory, hits and last access
+   * of every entry (see ResourceStats.hpp). The counters aren't kept if RESOURCE_STATS is defined
+   * as 0, in which case only the entry counts and memory are filled in.
+   * 
+   * @param includeEntries Whether to include every entry, rather than just the totals for each type
+   * @return ResourceStats The snapshot, which can be written out with toJson()
+   */
+  static ResourceStats snapshot(bool includeEntries = true);
+
+  /**
+   * @brief Watch the folders passed to preLoadTextures, preLoadSoundBuffers and preLoadFonts (before
+   * or after this is called) for files that change, so that reloadChangedFiles() can load them again.
+   * Only available on Linux (through inotify).
+   * 
+   * @param enabled Whether to watch the folders
+   * @param settleDelay How long a file has to go without being written to before it is reloaded, so
+   * that a file (or a whole folder) being exported is only reloaded once it is finished
+   * @return true Hot reloading is on (or was turned off)
+   * @return false Hot reloading isn't available on this platform; it is off
+   */
+  static bool setHotReload(bool enabled, sf::Time settleDelay = sf::milliseconds(200));
+
+  /**
+   * @brief Reload the files in the watched folders that have changed (and settled) since the last call.
+   * Each resource is reloaded in place, so existing pointers and handles stay valid and see the new
+   * contents. This should be called once per frame from the thread that owns the GL context.
+   * 
+   * @return int The number of resources that were reloaded (including files that were missing before)
+   */
+  static int reloadChangedFiles();
+
+  /**
+   * @brief Forget which files couldn't be loaded, so that the next lookup of each tries the disk again.
+   * Until then (or until hot reloading sees the file appear), a missing file is only looked up once,
+   * and every path that couldn't be loaded points to one shared copy of the invalid resource.
+   * 
+   * @return int The number of missing files that were forgotten (or loaded, for held ones)
+   */
+  static int forgetMissingFiles();
+
+  /***************************
+   *    BUNDLE METHODS 
+   **************************/
+
+  /**
+   * @brief Read the manifest that lists the bundles (see ResourceManifest.hpp for the format). It is
+   * read from the mounted pack if the pack has it, otherwise from the filesystem. Bundles that are
+   * already loaded stay loaded.
+   * 
+   * @param manifestPath The location of the manifest
+   * @return true The manifest was read
+   * @return false The manifest couldn't be read or has an invalid line; there are no bundles
+   */
+  static bool loadManifest(const std::string manifestPath);
+
+  /**
+   * @brief Load every file listed in a bundle of the manifest, highest priority first, without
+   * scanning any folders. Files with the same priority are decoded together across the preload
+   * threads. The files are held (as with getTextureHandle etc.) until the bundle is unloaded, so
+   * they aren't evicted by the memory budgets in the meantime. Sounds above the streaming
+   * threshold are streamed, as with preLoadSoundBuffers.
+   * 
+   * @param name The name of the bundle
+   * @return true The bundle was loaded (or already had been)
+   * @return false There is no bundle with that name
+   */
+  static bool loadBundle(const std::string name);
+
+  /**
+   * @brief Release the files of a bundle as a group. Files that are still held by another loaded bundle
+   * (or any other handle) stay loaded, as do files that were already loaded (eg. with getTexture) before
+   * a bundle or scope took them; the rest are unloaded.
+   * 
+   * @param name The name of the bundle
+   * @return int The number of resources that were unloaded
+   */
+  static int unloadBundle(const std::string name);
+
+  /**
+   * @brief Whether a bundle has been loaded (and not unloaded since)
+   */
+  static bool isBundleLoaded(const std::string name);
+
+  /***************************
+   *    TRACE METHODS 
+   **************************/
+
+  /**
+   * @brief Start recording the order (and time) in which resources are first looked up, through any
+   * of the get, handle and request methods, to be saved with saveTrace. Preloads, bundles and font
+   * warming aren't recorded, but their resources are when they are first looked up. This should be
+   * called at the same point of startup as startPrefetch, so that the times line up.
+   */
+  static void startTrace();
+
+  /**
+   * @brief Stop recording, and write the trace (with the memory each resource uses, if it is still
+   * loaded) to a file, see AccessTrace.hpp for the format
+   * 
+   * @param tracePath The location of the trace
+   * @return true The trace was written
+   * @return false There is no trace being recorded, or the file couldn't be written
+   */
+  static bool saveTrace(const std::string tracePath);
+
+  /**
+   * @brief Replay a trace saved by an earlier run: each file in it is requested in the background
+   * (see requestTexture) the lookahead before the time it was looked up in that run, so that it is
+   * usually loaded by the time it is looked up in this one. Files are queued as pump() is called,
+   * in the order of the trace, and only as far as the budget allows; files that don't fit in the
+   * memory budget are skipped, and files over the IO budget wait for a later pump.
+   * 
+   * @param tracePath The location of the trace
+   * @param budget The memory, IO and lookahead limits
+   * @return true The trace was read, and prefetching has started
+   * @return false The trace couldn't be read
+   */
+  static bool startPrefetch(const std::string tracePath, const PrefetchBudget& budget = PrefetchBudget());
+
+  /**
+   * @brief Stop queueing files from the trace. Files that are already queued are still loaded.
+   */
+  static void stopPrefetch();
+
+  /**
+   * @brief Get the number of files that the prefetcher has queued since it was started
+   * 
+   * @return int The number of files queued
+   */
+  static int getNumberOfPrefetched();
 };
\ No newline at end of file
@@ -0,0 +1,119 @@
+#include "ResourceManifest.hpp"
+#include "TextParsing.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <sstream>
+
+bool ResourceManifest::loadFromFile(const std::string& filePath) {
+  std::ifstream file(filePath, std::ios::binary);
+  if (!file) {
+    clear();
+    return false;
+  }
+
+  std::ostringstream contents;
+  contents << file.rdbuf();
+  return loadFromMemory(contents.str());
+}
+
+bool ResourceManifest::loadFromMemory(std::string_view text) {
+  clear();
+
+  std::vector<ManifestItem>* bundle = nullptr;
+  int lineNumber = 0;
+
+  while (!text.empty()) {
+    std::string_view line = nextLine(text);
+    lineNumber++;
+
+    if (line.empty() || line.front() == '#')
+      continue;
+
+    if (line.front() == '[') {
+      std::string_view name = line.back() == ']' ? trimWhitespace(line.substr(1, line.size() - 2)) : std::string_view();
+      if (name.empty()) {
+        clear();
+        m_errorLine = lineNumber;
+        return false;
+      }
+
+      bundle = &m_bundles[std::string(name)];
+      continue;
+    }
+
+    // Every item has to be in a bundle, and have a type, a priority and a path
+    ManifestItem item;
+    std::string_view type = nextWord(line);
+    std::string_view priority = nextWord(line);
+    auto [last, error] = std::from_chars(priority.data(), priority.data() + priority.size(), item.priority);
+
+    if (!bundle || !parseType(type, item.type) || error != std::errc() ||
+        last != priority.data() + priority.size() || line.empty()) {
+      clear();
+      m_errorLine = lineNumber;
+      return false;
+    }
+
+    item.path = line;
+    bundle->push_back(std::move(item));
+  }
+
+  for (auto& element: m_bundles) {
+    std::stable_sort(element.second.begin(), element.second.end(), [](const ManifestItem& a, const ManifestItem& b) {
+      return a.priority > b.priority;
+    });
+  }
+
+  return true;
+}
+
+const std::vector<ManifestItem>* ResourceManifest::getBundle(std::string_view name) const {
+  auto it = m_bundles.find(name);
+  return it == m_bundles.end() ? nullptr : &it->second;
+}
+
+std::vector<std::string> ResourceManifest::getBundleNames() const {
+  std::vector<std::string> names;
+  for (auto& element: m_bundles)
+    names.push_back(element.first);
+  return names;
+}
+
+int ResourceManifest::getErrorLine() const {
+  return m_errorLine;
+}
+
+void ResourceManifest::clear() {
+  m_bundles.clear();
+  m_errorLine = 0;
+}
+
+const char* ResourceManifest::getTypeName(ResourceType type) {
+  switch (type) {
+    case ResourceType::Texture:
+      return "texture";
+    case ResourceType::Sound:
+      return "sound";
+    case ResourceType::Music:
+      return "music";
+    default:
+      return "font";
+  }
+}
+
+bool ResourceManifest::parseType(std::string_view name, ResourceType& type) {
+  if (name == "texture")
+    type = ResourceType::Texture;
+  else if (name == "sound")
+    type = ResourceType::Sound;
+  else if (name == "music")
+    type = ResourceType::Music;
+  else if (name == "font")
+    type = ResourceType::Font;
+  else
+    return false;
+
+  return true;
+}
@@ -0,0 +1,106 @@
+/*
+DEPENDENCIES:
+std::map
+std::string
+std::string_view
+std::vector
+*/
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+A manifest lists named bundles of files (eg. "level3", "ui", "boss_audio"), so that everything a
+part of the game needs can be loaded and released together (see ResourceManager::loadBundle)
+without laying the folders out by load phase or scanning them.
+
+FORMAT (one item per line, '#' starts a comment line):
+
+  [level3]
+  texture 10 textures/level3/tiles.png
+  texture 0  textures/level3/background.png
+  sound   5  sounds/door.wav
+  music   0  music/level3.ogg
+  font    0  fonts/title.ttf
+
+Each item is a type (texture, sound, music or font), a priority and a path, which is the rest of
+the line, so it can contain spaces. Higher priorities are loaded first; items with the same
+priority keep the order they are listed in. A bundle can be split over several sections with the
+same name, and a file can be in any number of bundles.
+*/
+
+enum class ResourceType {
+  Texture,
+  Sound,
+  Music,
+  Font
+};
+
+struct ManifestItem {
+  ResourceType type;
+  int priority = 0;
+  std::string path;
+};
+
+class ResourceManifest {
+
+public:
+  /**
+   * @brief Read a manifest file, replacing the bundles that are currently loaded
+   *
+   * @param filePath The location of the manifest
+   * @return true The manifest was read
+   * @return false The file couldn't be read, or has an invalid line (see getErrorLine); no bundles are kept
+   */
+  bool loadFromFile(const std::string& filePath);
+
+  /**
+   * @brief Read a manifest from text in memory, as with loadFromFile
+   *
+   * @param text The contents of the manifest
+   * @return true The manifest was read
+   * @return false There is an invalid line (see getErrorLine); no bundles are kept
+   */
+  bool loadFromMemory(std::string_view text);
+
+  /**
+   * @brief Get the items of a bundle, sorted by priority (highest first)
+   *
+   * @param name The name of the bundle
+   * @return const std::vector<ManifestItem>* The items, or nullptr if there is no such bundle
+   */
+  const std::vector<ManifestItem>* getBundle(std::string_view name) const;
+
+  /**
+   * @brief Get the names of all of the bundles, sorted
+   */
+  std::vector<std::string> getBundleNames() const;
+
+  /**
+   * @brief Get the line (counting from 1) that made the last load fail, or 0 if it didn't
+   */
+  int getErrorLine() const;
+
+  void clear();
+
+  /**
+   * @brief Get the name a type is written as ("texture", "sound", "music" or "font")
+   */
+  static const char* getTypeName(ResourceType type);
+
+  /**
+   * @brief Read a type from its name, see getTypeName
+   *
+   * @return true The name is a type
+   * @return false The name isn't one of the types; type is left as it is
+   */
+  static bool parseType(std::string_view name, ResourceType& type);
+
+private:
+  std::map<std::string, std::vector<ManifestItem>, std::less<>> m_bundles;
+  int m_errorLine = 0;
+};
@@ -0,0 +1,203 @@
+#include "ResourcePack.hpp"
+#include "Hash.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+ResourcePack::~ResourcePack() {
+  close();
+}
+
+bool ResourcePack::open(const std::string& filePath) {
+  close();
+
+  if (!m_file.open(filePath))
+    return false;
+
+  m_data = m_file.getData();
+  m_size = m_file.getSize();
+
+  if (!validate()) {
+    close();
+    return false;
+  }
+
+  return true;
+}
+
+void ResourcePack::close() {
+  m_file.close();
+
+  m_data = nullptr;
+  m_size = 0;
+  m_entries = nullptr;
+  m_entryCount = 0;
+  m_names = nullptr;
+}
+
+bool ResourcePack::isOpen() const {
+  return m_data != nullptr;
+}
+
+bool ResourcePack::find(std::string_view filePath, const void*& data, std::size_t& size) const {
+  if (!m_entries)
+    return false;
+
+  std::uint64_t hash = hashString(filePath);
+
+  const Entry* end = m_entries + m_entryCount;
+  const Entry* entry = std::lower_bound(m_entries, end, hash, [](const Entry& e, std::uint64_t h) {
+    return e.hash < h;
+  });
+
+  // Different paths can (very rarely) have the same hash, so we still compare the names
+  for (; entry != end && entry->hash == hash; entry++) {
+    if (std::string_view(m_names + entry->nameOffset, entry->nameLength) == filePath) {
+      data = m_data + entry->offset;
+      size = static_cast<std::size_t>(entry->size);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+std::size_t ResourcePack::getNumberOfEntries() const {
+  return m_entryCount;
+}
+
+std::string_view ResourcePack::getPath(std::size_t index) const {
+  return std::string_view(m_names + m_entries[index].nameOffset, m_entries[index].nameLength);
+}
+
+bool ResourcePack::build(const std::string& folderPath, const std::string& packPath, std::uint32_t alignment) {
+  if (alignment == 0)
+    alignment = 1;
+
+  // Collect the files first, sorted so that the same folder always gives the same pack
+  // A folder that can't be read fails the build (rather than throwing), so that a pack is never
+  // silently missing files
+  std::vector<std::filesystem::path> files;
+  std::error_code error;
+  std::filesystem::recursive_directory_iterator it(folderPath, error), end;
+  for (; !error && it != end; it.increment(error)) {
+    if (it->is_regular_file(error))
+      files.push_back(it->path());
+  }
+  if (error)
+    return false;
+
+  std::sort(files.begin(), files.end());
+
+  std::ofstream pack(packPath, std::ios::binary | std::ios::trunc);
+  if (!pack)
+    return false;
+
+  // The header is written again at the end, once the offsets are known
+  Header header;
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  header.entryCount = static_cast<std::uint32_t>(files.size());
+  header.alignment = alignment;
+  header.indexOffset = 0;
+  header.namesOffset = 0;
+  pack.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  std::vector<Entry> entries;
+  std::string names;
+  std::uint64_t offset = sizeof(header);
+  const char zeros[64] = {};
+
+  auto pad = [&](std::uint64_t to) {
+    std::uint64_t padded = (offset + to - 1) / to * to;
+    while (offset < padded) {
+      std::uint64_t count = std::min<std::uint64_t>(padded - offset, sizeof(zeros));
+      pack.write(zeros, count);
+      offset += count;
+    }
+  };
+
+  for (const std::filesystem::path& file: files) {
+    std::ifstream input(file, std::ios::binary);
+    if (!input)
+      return false;
+
+    std::vector<char> contents((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+
+    pad(alignment);
+
+    // The stored path is what the file would be requested as
+    std::string name = file.generic_string();
+
+    Entry entry;
+    entry.hash = hashString(name);
+    entry.offset = offset;
+    entry.size = contents.size();
+    entry.nameOffset = static_cast<std::uint32_t>(names.size());
+    entry.nameLength = static_cast<std::uint32_t>(name.size());
+    entries.push_back(entry);
+    names += name;
+
+    pack.write(contents.data(), contents.size());
+    offset += contents.size();
+  }
+
+  std::sort(entries.begin(), entries.end(), [&](const Entry& a, const Entry& b) {
+    if (a.hash != b.hash)
+      return a.hash < b.hash;
+    return names.compare(a.nameOffset, a.nameLength, names, b.nameOffset, b.nameLength) < 0;
+  });
+
+  // The index is read straight out of the mapping, so it has to be aligned for its integers
+  pad(alignof(Entry));
+  header.indexOffset = offset;
+  pack.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(Entry));
+  offset += entries.size() * sizeof(Entry);
+
+  header.namesOffset = offset;
+  pack.write(names.data(), names.size());
+
+  pack.seekp(0);
+  pack.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  return static_cast<bool>(pack);
+}
+
+bool ResourcePack::validate() {
+  if (m_size < sizeof(Header))
+    return false;
+
+  Header header;
+  std::memcpy(&header, m_data, sizeof(header));
+
+  if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION)
+    return false;
+
+  // The offsets and sizes are compared by subtracting from the (known to be larger) bounds, so that
+  // huge values in a corrupt file can't overflow past them
+  std::uint64_t indexSize = static_cast<std::uint64_t>(header.entryCount) * sizeof(Entry);
+  if (header.indexOffset % alignof(Entry) != 0 || header.indexOffset > m_size ||
+      indexSize > m_size - header.indexOffset || header.namesOffset < header.indexOffset + indexSize ||
+      header.namesOffset > m_size)
+    return false;
+
+  const Entry* entries = reinterpret_cast<const Entry*>(m_data + header.indexOffset);
+  std::uint64_t namesSize = m_size - header.namesOffset;
+
+  // Every entry has to point inside the file, so that find() never has to check
+  for (std::size_t i = 0; i < header.entryCount; i++) {
+    if (entries[i].offset > header.indexOffset || entries[i].size > header.indexOffset - entries[i].offset ||
+        static_cast<std::uint64_t>(entries[i].nameOffset) + entries[i].nameLength > namesSize)
+      return false;
+  }
+
+  m_entries = entries;
+  m_entryCount = header.entryCount;
+  m_names = reinterpret_cast<const char*>(m_data + header.namesOffset);
+
+  return true;
+}
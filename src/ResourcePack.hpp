@@ -0,0 +1,129 @@
+/*
+DEPENDENCIES:
+std::filesystem
+std::string_view
+MappedFile
+*/
+
+#pragma once
+
+#include "MappedFile.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/*
+A pack file holds many asset files in one, so that they can all be read with a single open
+and a single memory map instead of an open/stat/read for each file.
+
+LAYOUT (all integers little endian):
+
+  Header      "SFRP", version, entry count, blob alignment, index offset, names offset
+  Blobs       The contents of each file, each starting at a multiple of the alignment
+  Index       One Entry per file, sorted by the hash of its path (see Hash.hpp)
+  Names       The paths of the files, back to back
+
+The paths are stored as they would be passed to getTexture etc., i.e. the folder given to
+build() joined with the path of the file inside it, using '/' as the separator.
+
+Lookups are a binary search on the hash, and return a pointer straight into the mapping, which
+stays valid until the pack is closed.
+*/
+
+class ResourcePack {
+
+public:
+  ResourcePack() = default;
+  ResourcePack(const ResourcePack&) = delete;
+  ResourcePack& operator=(const ResourcePack&) = delete;
+
+  ~ResourcePack();
+
+  /**
+   * @brief Map a pack file into memory, closing any previously open pack
+   * 
+   * @param filePath The location of the pack file
+   * @return true The pack was opened and is valid
+   * @return false The file couldn't be mapped or isn't a valid pack
+   */
+  bool open(const std::string& filePath);
+
+  /**
+   * @brief Unmap the pack. Any data returned by find() becomes invalid.
+   */
+  void close();
+
+  /**
+   * @brief Whether a pack is currently open
+   */
+  bool isOpen() const;
+
+  /**
+   * @brief Find the contents of a file in the pack. Safe to call from several threads at once.
+   * 
+   * @param filePath The path of the file, as it would be passed to getTexture etc.
+   * @param data Will be set to the start of the file contents (inside the mapping)
+   * @param size Will be set to the size of the file contents
+   * @return true The file is in the pack
+   * @return false The file isn't in the pack
+   */
+  bool find(std::string_view filePath, const void*& data, std::size_t& size) const;
+
+  /**
+   * @brief Get the number of files in the pack
+   */
+  std::size_t getNumberOfEntries() const;
+
+  /**
+   * @brief Get the path of the file at the given position in the index
+   */
+  std::string_view getPath(std::size_t index) const;
+
+  /**
+   * @brief Write all of the files below a folder into a new pack file
+   * 
+   * @param folderPath The folder to pack. This is also the prefix of the stored paths
+   * @param packPath The pack file to create
+   * @param alignment The alignment of each file's contents inside the pack
+   * @return true The pack was written
+   * @return false The folder couldn't be read or the pack couldn't be written
+   */
+  static bool build(const std::string& folderPath, const std::string& packPath, std::uint32_t alignment = 16);
+
+private:
+  struct Header {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t entryCount;
+    std::uint32_t alignment;
+    std::uint64_t indexOffset;
+    std::uint64_t namesOffset;
+  };
+
+  struct Entry {
+    std::uint64_t hash;
+    std::uint64_t offset;
+    std::uint64_t size;
+    std::uint32_t nameOffset;
+    std::uint32_t nameLength;
+  };
+
+  static constexpr char MAGIC[4] = {'S', 'F', 'R', 'P'};
+  static constexpr std::uint32_t VERSION = 1;
+
+  /**
+   * @brief Check that the header and index of the mapped file are consistent, and point
+   * m_entries and m_names at them
+   */
+  bool validate();
+
+  MappedFile m_file;
+  const unsigned char* m_data = nullptr;
+  std::size_t m_size = 0;
+
+  const Entry* m_entries = nullptr;
+  std::size_t m_entryCount = 0;
+  const char* m_names = nullptr;
+};
@@ -0,0 +1,129 @@
+/*
+DEPENDENCIES:
+std::mutex
+std::vector
+std::unique_ptr
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+/*
+A pool that the resource objects of one type are allocated from, instead of a separate new for
+each. Objects are placed in slabs of SLAB_SIZE slots, and a destroyed object's slot goes on a
+free list to be reused by the next one, so loading and unloading levels over a long session
+keeps reusing the same few blocks rather than scattering objects of every size across the heap.
+Slabs are only freed with the pool itself.
+
+Only the objects themselves live in the pool; whatever they allocate (pixels, samples, the
+font file) is still up to SFML.
+
+Safe to use from several threads at once.
+*/
+
+template<typename T>
+class ResourcePool {
+
+public:
+  static constexpr std::size_t SLAB_SIZE = 32;
+
+  ResourcePool() = default;
+  ResourcePool(const ResourcePool&) = delete;
+  ResourcePool& operator=(const ResourcePool&) = delete;
+
+  /**
+   * @brief Every object has to have been destroyed before the pool is
+   */
+  ~ResourcePool() = default;
+
+  /**
+   * @brief Construct an object in a free slot, adding a slab if there isn't one
+   *
+   * @param args The arguments for the constructor of T
+   * @return T* The new object, to be given back with destroy()
+   */
+  template<typename... Args>
+  T* create(Args&&... args) {
+    Slot* slot = take();
+
+    try {
+      return ::new (static_cast<void*>(slot->storage)) T(std::forward<Args>(args)...);
+    } catch (...) {
+      give(slot);
+      throw;
+    }
+  }
+
+  /**
+   * @brief Destroy an object made by create(), and free its slot. Does nothing for nullptr.
+   */
+  void destroy(T* object) {
+    if (!object)
+      return;
+
+    object->~T();
+    give(reinterpret_cast<Slot*>(object));
+  }
+
+  /**
+   * @brief The number of objects currently in the pool
+   */
+  std::size_t getSize() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_size;
+  }
+
+  /**
+   * @brief The number of objects the pool has room for without adding a slab
+   */
+  std::size_t getCapacity() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_slabs.size() * SLAB_SIZE;
+  }
+
+private:
+  /**
+   * @brief Either holds an object, or (while free) points to the next free slot
+   */
+  union Slot {
+    Slot* next;
+    alignas(T) unsigned char storage[sizeof(T)];
+  };
+
+  Slot* take() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (!m_free) {
+      m_slabs.push_back(std::make_unique<Slot[]>(SLAB_SIZE));
+
+      // Linked so that the slab is handed out from the start
+      Slot* slab = m_slabs.back().get();
+      for (std::size_t i = 0; i < SLAB_SIZE; i++)
+        slab[i].next = i + 1 < SLAB_SIZE ? &slab[i + 1] : nullptr;
+      m_free = slab;
+    }
+
+    Slot* slot = m_free;
+    m_free = slot->next;
+    m_size++;
+    return slot;
+  }
+
+  void give(Slot* slot) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    slot->next = m_free;
+    m_free = slot;
+    m_size--;
+  }
+
+  std::vector<std::unique_ptr<Slot[]>> m_slabs;
+  Slot* m_free = nullptr;
+  std::size_t m_size = 0;
+  mutable std::mutex m_mutex;
+};
@@ -0,0 +1,52 @@
+#include "ResourceScope.hpp"
+
+#include <utility>
+
+ResourceScope::ResourceScope(ResourceScope&& other) noexcept:
+    m_resources(std::exchange(other.m_resources, ResourceManager::LoadedBundle())) {}
+
+ResourceScope& ResourceScope::operator=(ResourceScope&& other) noexcept {
+  if (this != &other) {
+    release();
+    m_resources = std::exchange(other.m_resources, ResourceManager::LoadedBundle());
+  }
+  return *this;
+}
+
+ResourceScope::~ResourceScope() {
+  release();
+}
+
+sf::Texture* ResourceScope::getTexture(std::string_view filePath) {
+  return ResourceManager::holdFile(ResourceManager::m_textures, filePath, m_resources.textures);
+}
+
+sf::SoundBuffer* ResourceScope::getSoundBuffer(std::string_view filePath) {
+  return ResourceManager::holdFile(ResourceManager::m_sounds, filePath, m_resources.sounds);
+}
+
+sf::Music* ResourceScope::getMusic(std::string_view filePath) {
+  return ResourceManager::holdFile(ResourceManager::m_music, filePath, m_resources.music);
+}
+
+sf::Font* ResourceScope::getFont(std::string_view filePath) {
+  return ResourceManager::holdFile(ResourceManager::m_fonts, filePath, m_resources.fonts);
+}
+
+bool ResourceScope::loadBundle(const std::string name) {
+  const std::vector<ManifestItem>* items = ResourceManager::m_manifest.getBundle(name);
+  if (!items)
+    return false;
+
+  ResourceManager::loadItems(*items, m_resources);
+  return true;
+}
+
+int ResourceScope::release() {
+  return ResourceManager::unloadItems(m_resources);
+}
+
+int ResourceScope::getNumberOfResources() const {
+  return m_resources.textures.handles.size() + m_resources.sounds.handles.size() +
+         m_resources.music.handles.size() + m_resources.fonts.handles.size();
+}
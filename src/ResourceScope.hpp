@@ -0,0 +1,107 @@
+/*
+DEPENDENCIES:
+std::string
+std::string_view
+sf::Texture
+sf::SoundBuffer
+sf::Music
+sf::Font
+ResourceManager
+*/
+
+#pragma once
+
+#include "ResourceManager.hpp"
+
+#include <string>
+#include <string_view>
+
+/*
+A group of resources that are loaded and released together, eg. everything that belongs to one
+level. Resources are loaded through the scope into the manager as usual, so they can be looked up
+from anywhere (with ResourceManager::getTexture etc.) for as long as the scope is alive, and the
+scope holds them so that the memory budgets can't evict them in the meantime. When the scope is
+destroyed (or released), everything loaded through it is unloaded at once, with a single lock
+per type, except for the resources that something else still holds. Resources that were already
+loaded before the scope took them are left loaded as well, since the game may still be using them
+through the pointers it got from ResourceManager::getTexture etc.
+
+A scope is only meant to be used from one thread, and has to be destroyed before the manager's
+caches are, so it shouldn't be kept in a static.
+
+  {
+    ResourceScope level;
+    level.loadBundle("level1");
+    sf::Texture* boss = level.getTexture("assets/boss.png");
+
+    // ... play the level, getTexture finds everything the scope loaded ...
+  }
+  // Everything that the level loaded is gone again
+*/
+
+class ResourceScope {
+
+public:
+  ResourceScope() = default;
+
+  ResourceScope(const ResourceScope&) = delete;
+  ResourceScope& operator=(const ResourceScope&) = delete;
+
+  ResourceScope(ResourceScope&& other) noexcept;
+  ResourceScope& operator=(ResourceScope&& other) noexcept;
+
+  ~ResourceScope();
+
+  /**
+   * @brief Get the texture at the given path, as with ResourceManager::getTexture, and make it
+   * part of the scope (if it isn't already)
+   *
+   * @param filePath The (relative to project folder or absolute) location of the texture file
+   * @return sf::Texture* A pointer to the texture, valid until the scope is released
+   */
+  sf::Texture* getTexture(std::string_view filePath);
+
+  /**
+   * @brief Get the sound buffer at the given path and make it part of the scope, see getTexture
+   */
+  sf::SoundBuffer* getSoundBuffer(std::string_view filePath);
+
+  /**
+   * @brief Get the music at the given path and make it part of the scope, see getTexture
+   */
+  sf::Music* getMusic(std::string_view filePath);
+
+  /**
+   * @brief Get the font at the given path and make it part of the scope, see getTexture
+   */
+  sf::Font* getFont(std::string_view filePath);
+
+  /**
+   * @brief Load every file of a bundle of the manifest (as with ResourceManager::loadBundle) into
+   * the scope, rather than keeping them loaded until the bundle is unloaded
+   *
+   * @param name The name of the bundle
+   * @return true The files were loaded
+   * @return false There is no bundle with that name
+   */
+  bool loadBundle(const std::string name);
+
+  /**
+   * @brief Unload everything loaded through the scope, except for the resources that something
+   * else (another scope, a loaded bundle, a handle) still holds, and the ones that were already
+   * loaded before the scope took them. The scope is empty afterwards, and can be used again.
+   *
+   * @return int The number of resources that were unloaded
+   */
+  int release();
+
+  /**
+   * @brief Returns the number of resources in the scope
+   *
+   * @return int The number of resources held
+   */
+  int getNumberOfResources() const;
+
+private:
+  ResourceManager::LoadedBundle m_resources;
+};
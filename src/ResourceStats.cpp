@@ -0,0 +1,64 @@
+#include "ResourceStats.hpp"
+
+#include <cstdio>
+#include <sstream>
+
+// Paths can contain anything, so they have to be escaped
+static void writeString(std::ostringstream& out, const std::string& str) {
+  out << '"';
+  for (char c: str) {
+    if (c == '"' || c == '\\') {
+      out << '\\' << c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char escaped[8];
+      std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+      out << escaped;
+    } else {
+      out << c;
+    }
+  }
+  out << '"';
+}
+
+std::string ResourceStats::toJson() const {
+  std::ostringstream out;
+
+  out << "{\"caches\":[";
+  for (std::size_t i = 0; i < caches.size(); i++) {
+    const ResourceCacheStats& cache = caches[i];
+    if (i > 0)
+      out << ',';
+
+    out << "{\"type\":";
+    writeString(out, cache.type);
+    out << ",\"hits\":" << cache.hits;
+    out << ",\"misses\":" << cache.misses;
+    out << ",\"fallbacks\":" << cache.fallbacks;
+    out << ",\"load_seconds\":" << cache.loadSeconds;
+    out << ",\"entries\":" << cache.entries;
+    out << ",\"bytes\":" << cache.bytes;
+    out << ",\"budget\":" << cache.budget;
+    out << ",\"deduplicated_bytes\":" << cache.deduplicatedBytes;
+
+    out << ",\"entry_stats\":[";
+    for (std::size_t j = 0; j < cache.entryStats.size(); j++) {
+      const ResourceEntryStats& entry = cache.entryStats[j];
+      if (j > 0)
+        out << ',';
+
+      out << "{\"path\":";
+      writeString(out, entry.path);
+      out << ",\"load_seconds\":" << entry.loadSeconds;
+      out << ",\"bytes\":" << entry.bytes;
+      out << ",\"hits\":" << entry.hits;
+      out << ",\"last_access\":" << entry.lastAccess;
+      out << ",\"pending\":" << (entry.pending ? "true" : "false");
+      out << ",\"failed\":" << (entry.failed ? "true" : "false");
+      out << '}';
+    }
+    out << "]}";
+  }
+  out << "]}";
+
+  return out.str();
+}
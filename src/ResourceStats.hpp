@@ -0,0 +1,187 @@
+/*
+DEPENDENCIES:
+std::atomic
+std::chrono
+std::string
+std::vector
+*/
+
+#pragma once
+
+#include "ReadMostlyMutex.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+Instrumentation for the resource caches: how long each resource took to load, how much memory
+it holds and how often it is used, along with hit/miss/fallback counts for each type. A copy of
+everything can be taken with ResourceManager::snapshot(), and written out with toJson().
+
+The counting is on by default. Building with RESOURCE_STATS defined as 0 compiles it out
+entirely; the counters become empty (and take no space in the entries), the timers don't read
+the clock, and a snapshot only has the entry counts and memory use.
+
+Accesses aren't timestamped, since reading the clock on every hit would cost about as much as
+the hit itself. Instead each lookup in a cache is numbered, and lastAccess is the number of the
+latest lookup of the entry, so (hits + misses - lastAccess) is how many lookups ago it was used.
+
+In a thread safe cache, a hit under the shared lock only counts towards the type, on a counter
+of its own thread's slot (see ReadMostlyMutex), so that readers never write to the same cache
+line; the hits and lastAccess of an entry only cover the lookups that took the exclusive lock.
+*/
+
+#ifndef RESOURCE_STATS
+#define RESOURCE_STATS 1
+#endif
+
+/**
+ * @brief The numbers for a single resource
+ */
+struct ResourceEntryStats {
+  std::string path;
+
+  /**
+   * @brief The time spent decoding and creating the resource, including reloads
+   */
+  double loadSeconds = 0;
+
+  /**
+   * @brief The memory counted against the budget for this entry (0 for resources shared through
+   * deduplication, which are counted once for the type)
+   */
+  std::size_t bytes = 0;
+
+  std::uint64_t hits = 0;
+
+  /**
+   * @brief The number of the latest lookup of the entry, see the top of ResourceStats.hpp
+   */
+  std::uint64_t lastAccess = 0;
+
+  /**
+   * @brief Whether the entry is still waiting for a background request to finish
+   */
+  bool pending = false;
+
+  /**
+   * @brief Whether the file couldn't be loaded, so the entry points to the invalid resource
+   */
+  bool failed = false;
+};
+
+/**
+ * @brief The numbers for a single type of resource
+ */
+struct ResourceCacheStats {
+  std::string type;
+
+  std::uint64_t hits = 0;
+  std::uint64_t misses = 0;
+
+  /**
+   * @brief The number of loads that failed and used the invalid file instead
+   */
+  std::uint64_t fallbacks = 0;
+
+  /**
+   * @brief The time spent loading resources (by lookups, preloads and requests)
+   */
+  double loadSeconds = 0;
+
+  int entries = 0;
+  std::size_t bytes = 0;
+  std::size_t budget = 0;
+  std::size_t deduplicatedBytes = 0;
+
+  /**
+   * @brief Every entry, if they were asked for
+   */
+  std::vector<ResourceEntryStats> entryStats;
+};
+
+struct ResourceStats {
+  std::vector<ResourceCacheStats> caches;
+
+  /**
+   * @brief Write the snapshot out as a JSON object
+   *
+   * @return std::string The JSON text
+   */
+  std::string toJson() const;
+};
+
+/**
+ * @brief Measures how long a load takes, or does nothing when the stats are compiled out
+ */
+class LoadTimer {
+
+public:
+#if RESOURCE_STATS
+  LoadTimer(): m_start(std::chrono::steady_clock::now()) {}
+
+  double getSeconds() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+  }
+
+private:
+  std::chrono::steady_clock::time_point m_start;
+#else
+  double getSeconds() const {
+    return 0;
+  }
+#endif
+};
+
+#if RESOURCE_STATS
+/**
+ * @brief The counters kept in each cache entry. They are only ever updated by one thread at a
+ * time (see the top of ResourceStats.hpp).
+ */
+struct EntryCounters {
+  double loadSeconds = 0;
+  std::uint64_t hits = 0;
+  std::uint64_t lastAccess = 0;
+};
+
+/**
+ * @brief The counters kept for each cache. Only the shared hits can be counted by several
+ * threads at once, so each slot's counter is atomic (with relaxed ordering) and on its own line.
+ */
+struct CacheCounters {
+  struct alignas(64) Shard {
+    std::atomic<std::uint64_t> hits{0};
+  };
+
+  std::uint64_t hits = 0;
+  std::uint64_t misses = 0;
+  std::uint64_t fallbacks = 0;
+  double loadSeconds = 0;
+  Shard sharedHits[ReadMostlyMutex::SLOTS];
+
+  /**
+   * @brief Every hit, shared or not
+   */
+  std::uint64_t getHits() const {
+    std::uint64_t total = hits;
+    for (const Shard& shard: sharedHits)
+      total += shard.hits.load(std::memory_order_relaxed);
+    return total;
+  }
+
+  /**
+   * @brief Move the shared hits into hits, while no other thread is counting
+   */
+  void foldSharedHits() {
+    for (Shard& shard: sharedHits)
+      hits += shard.hits.exchange(0, std::memory_order_relaxed);
+  }
+};
+#else
+struct EntryCounters {};
+struct CacheCounters {};
+#endif
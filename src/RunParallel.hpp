@@ -0,0 +1,49 @@
+/*
+DEPENDENCIES:
+std::thread
+std::atomic
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Run job(i) for every i in [0, count) across the given number of threads, and wait
+ * for all of them to finish. Each index is handed to exactly one thread, so jobs that only
+ * write to their own slot of some output don't need any locking.
+ * 
+ * @param count The number of jobs
+ * @param threads The maximum number of threads to use. 1 (or 0) runs everything on the calling thread
+ * @param job The callable to run for each index
+ */
+template<typename Job>
+void runParallel(std::size_t count, unsigned int threads, Job job) {
+  std::size_t workerCount = std::min<std::size_t>(threads, count);
+
+  // No need to spin up any threads if there is only one to use
+  if (workerCount <= 1) {
+    for (std::size_t i = 0; i < count; i++)
+      job(i);
+    return;
+  }
+
+  // Each worker grabs the next unclaimed index until there are none left
+  std::atomic<std::size_t> next(0);
+  std::vector<std::thread> workers;
+  workers.reserve(workerCount);
+
+  for (std::size_t t = 0; t < workerCount; t++) {
+    workers.emplace_back([&]() {
+      for (std::size_t i = next++; i < count; i = next++)
+        job(i);
+    });
+  }
+
+  for (std::thread& worker: workers)
+    worker.join();
+}
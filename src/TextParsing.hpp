@@ -0,0 +1,45 @@
+/*
+DEPENDENCIES:
+std::string_view
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <string_view>
+
+/*
+Small helpers for the line based text files (manifests, access traces).
+*/
+
+/**
+ * @brief Remove the whitespace at both ends of a string
+ */
+inline std::string_view trimWhitespace(std::string_view str) {
+  const char* whitespace = " \t\r\n";
+  std::size_t start = str.find_first_not_of(whitespace);
+  if (start == std::string_view::npos)
+    return std::string_view();
+
+  return str.substr(start, str.find_last_not_of(whitespace) - start + 1);
+}
+
+/**
+ * @brief Split off the first word of a line, leaving the rest (trimmed) in line
+ */
+inline std::string_view nextWord(std::string_view& line) {
+  std::size_t end = std::min(line.find_first_of(" \t"), line.size());
+  std::string_view word = line.substr(0, end);
+  line = trimWhitespace(line.substr(end));
+  return word;
+}
+
+/**
+ * @brief Split off the first line of some text (without its line break, and trimmed)
+ */
+inline std::string_view nextLine(std::string_view& text) {
+  std::size_t end = std::min(text.find('\n'), text.size());
+  std::string_view line = trimWhitespace(text.substr(0, end));
+  text = text.substr(std::min(end + 1, text.size()));
+  return line;
+}
@@ -0,0 +1,189 @@
+#include "TextureAtlas.hpp"
+
+#include <algorithm>
+#include <limits>
+
+TextureAtlas::TextureAtlas(unsigned int pageSize, unsigned int padding): m_pageSize(pageSize), m_padding(padding) {}
+
+TextureAtlas::~TextureAtlas() {
+  clear();
+}
+
+bool TextureAtlas::add(const std::string& filePath, const sf::Image& image) {
+  if (m_placements.find(filePath) != m_placements.end())
+    return false;
+
+  // The padding is added to the right and bottom of each image, so neighbours never touch
+  int width = image.getSize().x + m_padding;
+  int height = image.getSize().y + m_padding;
+
+  // We try the current pages first, oldest to newest
+  int x, y;
+  std::size_t node;
+  std::size_t page = 0;
+  for (; page < m_pages.size(); page++) {
+    if (findPosition(m_pages[page], width, height, x, y, node))
+      break;
+  }
+
+  // And if it didn't fit anywhere, we start a new page
+  if (page == m_pages.size()) {
+    Page newPage;
+    newPage.size = m_pageSize;
+    newPage.skyline.push_back(SkylineNode{0, 0, newPage.size});
+
+    if (!findPosition(newPage, width, height, x, y, node))
+      return false;
+
+    newPage.image.create(m_pageSize, m_pageSize, sf::Color::Transparent);
+    m_pages.push_back(std::move(newPage));
+  }
+
+  Page& target = m_pages[page];
+  placeRectangle(target, node, x, y, width, height);
+  target.image.copy(image, x, y);
+  target.dirty = true;
+
+  m_placements[filePath] = Placement{page, sf::IntRect(x, y, image.getSize().x, image.getSize().y)};
+  return true;
+}
+
+bool TextureAtlas::upload() {
+  bool uploaded = true;
+  for (Page& page: m_pages) {
+    if (!page.dirty)
+      continue;
+
+    // The texture is only kept once it has been created, so a failed page never hands out an empty one
+    if (!page.texture) {
+      auto texture = std::make_unique<sf::Texture>();
+      if (!texture->loadFromImage(page.image)) {
+        uploaded = false;
+        continue;
+      }
+      page.texture = std::move(texture);
+    } else {
+      page.texture->update(page.image);
+    }
+    page.dirty = false;
+  }
+
+  return uploaded;
+}
+
+bool TextureAtlas::contains(std::string_view filePath) const {
+  return m_placements.find(filePath) != m_placements.end();
+}
+
+AtlasRegion TextureAtlas::getRegion(std::string_view filePath) const {
+  AtlasRegion region;
+
+  auto it = m_placements.find(filePath);
+  if (it != m_placements.end()) {
+    region.texture = m_pages[it->second.page].texture.get();
+    region.rect = it->second.rect;
+  }
+
+  return region;
+}
+
+bool TextureAtlas::getPlacement(std::string_view filePath, std::size_t& page, sf::IntRect& rect) const {
+  auto it = m_placements.find(filePath);
+  if (it == m_placements.end())
+    return false;
+
+  page = it->second.page;
+  rect = it->second.rect;
+  return true;
+}
+
+const sf::Image& TextureAtlas::getPageImage(std::size_t page) const {
+  return m_pages[page].image;
+}
+
+std::size_t TextureAtlas::getNumberOfPages() const {
+  return m_pages.size();
+}
+
+std::size_t TextureAtlas::getNumberOfImages() const {
+  return m_placements.size();
+}
+
+void TextureAtlas::setPageSize(unsigned int pageSize) {
+  m_pageSize = pageSize;
+}
+
+unsigned int TextureAtlas::getPageSize() const {
+  return m_pageSize;
+}
+
+void TextureAtlas::clear() {
+  m_pages.clear();
+  m_placements.clear();
+}
+
+bool TextureAtlas::findPosition(const Page& page, int width, int height, int& x, int& y, std::size_t& node) {
+  int bestY = std::numeric_limits<int>::max();
+  int bestX = std::numeric_limits<int>::max();
+
+  for (std::size_t i = 0; i < page.skyline.size(); i++) {
+    int left = page.skyline[i].x;
+    if (left + width > page.size)
+      break;
+
+    // The rectangle has to sit on top of the highest segment it spans
+    int top = 0;
+    int spanned = 0;
+    for (std::size_t j = i; j < page.skyline.size() && spanned < width; j++) {
+      top = std::max(top, page.skyline[j].y);
+      spanned += page.skyline[j].width;
+    }
+
+    if (top + height > page.size)
+      continue;
+
+    if (top < bestY || (top == bestY && left < bestX)) {
+      bestY = top;
+      bestX = left;
+      node = i;
+    }
+  }
+
+  if (bestY == std::numeric_limits<int>::max())
+    return false;
+
+  x = bestX;
+  y = bestY;
+  return true;
+}
+
+void TextureAtlas::placeRectangle(Page& page, std::size_t node, int x, int y, int width, int height) {
+  std::vector<SkylineNode>& skyline = page.skyline;
+  skyline.insert(skyline.begin() + node, SkylineNode{x, y + height, width});
+
+  // Any segments that are now (partly) under the new one get cut down or removed
+  int right = x + width;
+  for (std::size_t i = node + 1; i < skyline.size();) {
+    if (skyline[i].x >= right)
+      break;
+
+    int overlap = right - skyline[i].x;
+    if (skyline[i].width <= overlap) {
+      skyline.erase(skyline.begin() + i);
+    } else {
+      skyline[i].x += overlap;
+      skyline[i].width -= overlap;
+      break;
+    }
+  }
+
+  // Neighbouring segments at the same height are merged to keep the skyline short
+  for (std::size_t i = 0; i + 1 < skyline.size();) {
+    if (skyline[i].y == skyline[i + 1].y) {
+      skyline[i].width += skyline[i + 1].width;
+      skyline.erase(skyline.begin() + i + 1);
+    } else {
+      i++;
+    }
+  }
+}
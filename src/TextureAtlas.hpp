@@ -0,0 +1,171 @@
+/*
+DEPENDENCIES:
+sf::Image
+sf::Texture
+sf::IntRect
+std::unordered_map
+std::unique_ptr
+PathHash
+*/
+
+#pragma once
+#include <SFML/Graphics.hpp>
+
+#include "PathHash.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/*
+Packs many small images into a few large texture pages, so that sprites drawn from the
+same page don't need a texture bind (or a new draw call) each.
+
+Images are placed with a skyline bottom-left bin packer as they are added. All of the
+packing is done into sf::Image pages on the CPU, so it can be run (and checked) without a
+graphics context; upload() then creates/updates the textures for the pages, and has to be
+called from the thread that owns the GL context before the regions' textures are used.
+*/
+
+/**
+ * @brief Where a packed image ended up: the page texture and the area of it that holds the image
+ */
+struct AtlasRegion {
+  sf::Texture* texture = nullptr;
+  sf::IntRect rect;
+};
+
+class TextureAtlas {
+
+public:
+  /**
+   * @brief Create an empty atlas
+   * 
+   * @param pageSize The width and height of each page in pixels
+   * @param padding The number of transparent pixels left between images, to avoid bleeding when filtering
+   */
+  explicit TextureAtlas(unsigned int pageSize = 2048, unsigned int padding = 1);
+
+  TextureAtlas(const TextureAtlas&) = delete;
+  TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+  ~TextureAtlas();
+
+  /**
+   * @brief Pack an image into the atlas, opening a new page if it doesn't fit in any of the current ones.
+   * Images are packed more tightly if they are added from tallest to shortest.
+   * 
+   * @param filePath The key the image can be found with afterwards
+   * @param image The image to copy into the atlas
+   * @return true The image was packed
+   * @return false The image (plus padding) is larger than a page, or the path is already in the atlas
+   */
+  bool add(const std::string& filePath, const sf::Image& image);
+
+  /**
+   * @brief Create the textures for new pages and update the ones that have had images added since the
+   * last upload. Must be called from the thread that owns the GL context.
+   * 
+   * @return true Every page has its texture
+   * @return false A page's texture couldn't be created (e.g. the page is larger than the graphics card
+   * allows); its regions keep a null texture, and it is tried again on the next upload
+   */
+  bool upload();
+
+  /**
+   * @brief Whether the given path has been packed into the atlas
+   */
+  bool contains(std::string_view filePath) const;
+
+  /**
+   * @brief Get the page texture and rectangle of a packed image. The texture is only set once the
+   * page has been uploaded.
+   * 
+   * @param filePath The path the image was added with
+   * @return AtlasRegion The region, with a null texture if the path isn't in the atlas
+   */
+  AtlasRegion getRegion(std::string_view filePath) const;
+
+  /**
+   * @brief Get the page index and rectangle of a packed image, without needing the page to be uploaded.
+   * 
+   * @param filePath The path the image was added with
+   * @param page Will be set to the index of the page
+   * @param rect Will be set to the area of the page holding the image
+   * @return true The path is in the atlas
+   * @return false The path isn't in the atlas
+   */
+  bool getPlacement(std::string_view filePath, std::size_t& page, sf::IntRect& rect) const;
+
+  /**
+   * @brief Get the CPU side image of a page
+   */
+  const sf::Image& getPageImage(std::size_t page) const;
+
+  /**
+   * @brief Get the number of pages in the atlas
+   */
+  std::size_t getNumberOfPages() const;
+
+  /**
+   * @brief Get the number of images packed into the atlas
+   */
+  std::size_t getNumberOfImages() const;
+
+  /**
+   * @brief Set the size of pages that are created from now on
+   */
+  void setPageSize(unsigned int pageSize);
+
+  unsigned int getPageSize() const;
+
+  /**
+   * @brief Delete all of the pages and forget every packed image
+   */
+  void clear();
+
+private:
+  /**
+   * @brief A horizontal segment of the top edge of the packed area of a page
+   */
+  struct SkylineNode {
+    int x;
+    int y;
+    int width;
+  };
+
+  struct Page {
+    int size = 0;
+    sf::Image image;
+    std::vector<SkylineNode> skyline;
+    std::unique_ptr<sf::Texture> texture;
+    bool dirty = true;
+  };
+
+  struct Placement {
+    std::size_t page;
+    sf::IntRect rect;
+  };
+
+  /**
+   * @brief Find the lowest (then leftmost) position on a page that fits a rectangle of the given size
+   * 
+   * @return true A position was found, and x, y and node are set to it
+   */
+  static bool findPosition(const Page& page, int width, int height, int& x, int& y, std::size_t& node);
+
+  /**
+   * @brief Raise the skyline of a page over a rectangle placed at the given node
+   */
+  static void placeRectangle(Page& page, std::size_t node, int x, int y, int width, int height);
+
+  std::vector<Page> m_pages;
+  std::unordered_map<std::string, Placement, PathHash, std::equal_to<>> m_placements;
+
+  unsigned int m_pageSize;
+  unsigned int m_padding;
+};
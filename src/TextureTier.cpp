@@ -0,0 +1,71 @@
+#include "TextureTier.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+unsigned int getTierDivisor(TextureTier tier) {
+  switch (tier) {
+    case TextureTier::Half:
+      return 2;
+    case TextureTier::Quarter:
+      return 4;
+    default:
+      return 1;
+  }
+}
+
+// Halve an image with a box filter. An odd last row or column is folded into the last row or
+// column of the result, which then averages three source pixels across instead of two
+static void halve(sf::Image& image) {
+  unsigned int width = image.getSize().x;
+  unsigned int height = image.getSize().y;
+  unsigned int halfWidth = std::max(1u, width / 2);
+  unsigned int halfHeight = std::max(1u, height / 2);
+
+  const sf::Uint8* source = image.getPixelsPtr();
+  std::vector<sf::Uint8> pixels(static_cast<std::size_t>(halfWidth) * halfHeight * 4);
+
+  for (unsigned int y = 0; y < halfHeight; y++) {
+    unsigned int top = 2 * y;
+    unsigned int bottom = y + 1 == halfHeight ? height : top + 2;
+    sf::Uint8* out = pixels.data() + static_cast<std::size_t>(y) * halfWidth * 4;
+
+    for (unsigned int x = 0; x < halfWidth; x++) {
+      unsigned int left = 2 * x;
+      unsigned int right = x + 1 == halfWidth ? width : left + 2;
+      unsigned int count = (bottom - top) * (right - left);
+
+      // The colours are averaged weighted by alpha, and the alpha itself is averaged plainly
+      unsigned int alpha = 0;
+      unsigned int colour[3] = {0, 0, 0};
+      unsigned int plain[3] = {0, 0, 0};
+      for (unsigned int row = top; row < bottom; row++) {
+        const sf::Uint8* pixel = source + (static_cast<std::size_t>(row) * width + left) * 4;
+        for (unsigned int column = left; column < right; column++, pixel += 4) {
+          alpha += pixel[3];
+          for (int c = 0; c < 3; c++) {
+            colour[c] += pixel[c] * pixel[3];
+            plain[c] += pixel[c];
+          }
+        }
+      }
+
+      for (int c = 0; c < 3; c++)
+        out[x * 4 + c] = static_cast<sf::Uint8>(alpha > 0 ? (colour[c] + alpha / 2) / alpha : (plain[c] + count / 2) / count);
+      out[x * 4 + 3] = static_cast<sf::Uint8>((alpha + count / 2) / count);
+    }
+  }
+
+  image.create(halfWidth, halfHeight, pixels.data());
+}
+
+void scaleToTier(sf::Image& image, TextureTier tier) {
+  // A quarter is two halvings
+  for (unsigned int divisor = getTierDivisor(tier); divisor > 1; divisor /= 2) {
+    sf::Vector2u size = image.getSize();
+    if (size.x == 0 || size.y == 0 || (size.x == 1 && size.y == 1))
+      break;
+    halve(image);
+  }
+}
@@ -0,0 +1,44 @@
+/*
+DEPENDENCIES:
+sf::Image
+*/
+
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+/*
+Resolution tiers for textures, so that machines with less memory can load every texture at a
+half or a quarter of its size. The images are scaled down on the CPU after decoding (on the
+preload workers, when preloading), before they are uploaded, so the full size texture never
+takes up video memory.
+
+With a DecodedCache, the scaled down images are stored as their own entries, one per tier, so
+later loads at the same tier skip both the decoder and the scaling.
+
+Note that the textures really are smaller: texture rects (and anything else in texture pixels)
+have to be divided by getTierDivisor() of the current tier.
+*/
+
+enum class TextureTier {
+  Full,
+  Half,
+  Quarter
+};
+
+/**
+ * @brief The factor a tier divides the width and height of textures by
+ *
+ * @return unsigned int 1, 2 or 4
+ */
+unsigned int getTierDivisor(TextureTier tier);
+
+/**
+ * @brief Scale an image down by a tier, with a box filter that weighs each pixel by its alpha
+ * (so that the colour of fully transparent pixels doesn't bleed into their neighbours). Each side
+ * is divided by the tier's divisor, rounding down, but never below 1 pixel.
+ *
+ * @param image The image, which is replaced by the scaled down one
+ * @param tier The tier to scale to; Full leaves the image as it is
+ */
+void scaleToTier(sf::Image& image, TextureTier tier);
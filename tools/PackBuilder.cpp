@@ -0,0 +1,37 @@
+/*
+Builds a pack file (see src/ResourcePack.hpp) out of every file below a folder.
+
+USAGE:
+  PackBuilder <folder> <pack file> [alignment]
+
+The files are stored under the paths they would be loaded with from the current directory,
+so the folder should be given the same way the game refers to it (e.g. "assets").
+*/
+
+#include "ResourcePack.hpp"
+
+#include <cstdlib>
+#include <iostream>
+
+int main(int argc, char** argv) {
+  if (argc < 3 || argc > 4) {
+    std::cerr << "Usage: " << argv[0] << " <folder> <pack file> [alignment]" << std::endl;
+    return 1;
+  }
+
+  std::uint32_t alignment = argc == 4 ? std::strtoul(argv[3], nullptr, 10) : 16;
+
+  if (!ResourcePack::build(argv[1], argv[2], alignment)) {
+    std::cerr << "Failed to build " << argv[2] << " from " << argv[1] << std::endl;
+    return 1;
+  }
+
+  ResourcePack pack;
+  if (!pack.open(argv[2])) {
+    std::cerr << "Built " << argv[2] << ", but it could not be opened again" << std::endl;
+    return 1;
+  }
+
+  std::cout << "Packed " << pack.getNumberOfEntries() << " files into " << argv[2] << std::endl;
+  return 0;
+}
@@ -0,0 +1,913 @@
+/*
+Benchmarks the resource caches on a synthetic tree of assets, and prints the results as JSON
+so that runs from different commits can be compared.
+
+USAGE:
+  ResourceBenchmark [--option=value ...]
+
+  --files=N          Files of each type to generate (default 200)
+  --depth=N          Folder levels to spread the files over; 0 puts them all in one folder (default 0)
+  --fanout=N         Folders per level when nesting (default 4)
+  --small-image=N    Width and height of the small images (default 32)
+  --large-image=N    Width and height of the large images (default 1024)
+  --small-sound=S    Length of the short sounds in seconds (default 0.5)
+  --large-sound=S    Length of the long sounds in seconds (default 10)
+  --large-ratio=R    Fraction of the images and sounds that are large (default 0.1)
+  --font=PATH        A .ttf file that is copied to make the fonts (default: a common system font,
+                     and fonts are skipped if there isn't one)
+  --threads=N        Preload worker threads, 0 for one per core (default 1)
+  --lookups=N        Lookups per hit measurement (default 1000000)
+  --concurrency=LIST Comma separated thread counts for the concurrent lookup scenario, or "none"
+                     (default 1,2,4,8)
+  --sweep=LIST       Comma separated entry counts for the hit latency sweep, or "none"
+                     (default 100,1000,10000,100000)
+  --dir=PATH         Where the tree is generated (default "benchmark_assets"), removed afterwards
+  --keep             Keep the generated tree (and reuse it on the next run)
+  --check-atlas      Only check the atlas packer (see below), and exit with 2 if it fails
+  --output=PATH      Write the JSON here instead of to stdout
+
+Everything runs headless: textures are measured as sf::Image (the caches and decoding are the
+same, only the upload to the graphics card is left out, since that needs a window) and sounds as
+their decoded samples, so neither a display nor an audio device is needed. getTexture and
+friends are thin wrappers around these same caches.
+
+Scanning is measured on the whole tree: once listing each type with its own walk (as the separate
+preLoad methods do) and once sorting every file into its type in a single walk (as preLoadAll does).
+A tree of 50k files is, for example, --files=17000 --depth=3 --large-ratio=0.
+
+The concurrent scenario starts every thread on an empty thread safe cache of the textures, so
+that the threads miss the same files at the same time, and then keep hitting them. It checks that
+each file was decoded exactly once and that every thread got the same pointer for it, and exits
+with 2 if not, so it doubles as a stress test. Building with -fsanitize=thread (and running with
+a small --files and --lookups) checks it for data races as well.
+
+The hit latency sweep fills a cache with synthetic keys (nothing is read from disk, and every
+entry is a plain int), so that the cost of a hit can be seen on its own as the number of entries
+grows. The keys are looked up in a shuffled order, so that the larger maps don't stay in the CPU
+cache just because of the order they were filled in.
+
+The atlas check packs images of random sizes (--files of them, some too large for a page) into
+the sf::Image pages of a TextureAtlas, without a graphics context, and checks that every packed
+image is inside its page, doesn't overlap any other (padding included), and has its own pixels
+there, and that only the images larger than a page were turned away.
+
+Needs src/ResourceLoaders.cpp, src/AsyncLoader.cpp, src/DecodedCache.cpp, src/MappedFile.cpp,
+src/ResourcePack.cpp, src/TextureTier.cpp, src/AccessTrace.cpp, src/ResourceManifest.cpp and
+src/TextureAtlas.cpp, and links against sfml-graphics and sfml-audio.
+*/
+
+#include "FileScan.hpp"
+#include "ResourceCache.hpp"
+#include "ResourceId.hpp"
+#include "ResourceLoaders.hpp"
+#include "TextureAtlas.hpp"
+
+#include <SFML/Audio.hpp>
+#include <SFML/Graphics.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+/**
+ * @brief TextureLoader, but creating sf::Image instead of sf::Texture so that no GL context is needed
+ */
+struct HeadlessTextureLoader: TextureLoader {
+  static bool load(sf::Image& image, const std::string& filePath, std::uint32_t variant = getVariant()) {
+    return decode(filePath, image, variant);
+  }
+
+  static bool loadFromMemory(sf::Image& image, const void* data, std::size_t size,
+                             std::uint32_t variant = getVariant()) {
+    return decodeFromMemory(data, size, image, variant);
+  }
+
+  static bool finalize(sf::Image& image, Decoded& decoded) {
+    std::swap(image, decoded);
+    return true;
+  }
+
+  static std::size_t getSize(const sf::Image& image) {
+    return static_cast<std::size_t>(image.getSize().x) * image.getSize().y * 4;
+  }
+};
+
+/**
+ * @brief SoundBufferLoader, but keeping the decoded samples instead of creating an sf::SoundBuffer
+ * (which opens the audio device)
+ */
+struct HeadlessSoundLoader: SoundBufferLoader {
+  static bool load(Decoded& sound, const std::string& filePath) {
+    return decode(filePath, sound);
+  }
+
+  static bool loadFromMemory(Decoded& sound, const void* data, std::size_t size) {
+    return decodeFromMemory(data, size, sound);
+  }
+
+  static bool finalize(Decoded& sound, Decoded& decoded) {
+    sound = std::move(decoded);
+    return true;
+  }
+
+  static std::size_t getSize(const Decoded& sound) {
+    return sound.samples.size() * sizeof(sf::Int16);
+  }
+};
+
+/**
+ * @brief HeadlessTextureLoader, counting how many times files are decoded
+ */
+struct CountingTextureLoader: HeadlessTextureLoader {
+  static inline std::atomic<long long> decodes{0};
+
+  static bool decode(const std::string& filePath, Decoded& image, std::uint32_t variant = getVariant()) {
+    decodes.fetch_add(1, std::memory_order_relaxed);
+    return HeadlessTextureLoader::decode(filePath, image, variant);
+  }
+};
+
+/**
+ * @brief A loader that doesn't read anything, for measuring the cache on its own
+ */
+struct SyntheticLoader {
+  typedef int Decoded;
+
+  static constexpr bool RETAIN_DECODED = false;
+  static constexpr const char* DEFAULT_INVALID_PATH = "invalid.dat";
+  static constexpr std::string_view EXTENSIONS[] = {"dat"};
+  static constexpr bool CACHE_DECODED = false;
+
+  static bool load(int& value, const std::string&) {
+    value = 1;
+    return true;
+  }
+
+  static bool loadFromMemory(int& value, const void*, std::size_t) {
+    value = 1;
+    return true;
+  }
+
+  static bool decode(const std::string&, Decoded& value) {
+    value = 1;
+    return true;
+  }
+
+  static bool decodeFromMemory(const void*, std::size_t, Decoded& value) {
+    value = 1;
+    return true;
+  }
+
+  static bool finalize(int& value, Decoded& decoded) {
+    value = decoded;
+    return true;
+  }
+
+  static std::size_t getSize(const int&) {
+    return sizeof(int);
+  }
+};
+
+struct Options {
+  int files = 200;
+  int depth = 0;
+  int fanout = 4;
+  unsigned int smallImage = 32;
+  unsigned int largeImage = 1024;
+  double smallSound = 0.5;
+  double largeSound = 10;
+  double largeRatio = 0.1;
+  std::string font;
+  unsigned int threads = 1;
+  long long lookups = 1000000;
+  std::vector<unsigned int> concurrency = {1, 2, 4, 8};
+  std::vector<unsigned int> sweep = {100, 1000, 10000, 100000};
+  std::string directory = "benchmark_assets";
+  bool keep = false;
+  bool checkAtlas = false;
+  std::string output;
+};
+
+/**
+ * @brief The numbers measured for a single type of resource
+ */
+struct Result {
+  std::string type;
+  int files = 0;
+  std::uintmax_t sourceBytes = 0;
+  double preLoadSeconds = 0;
+  int preLoaded = 0;
+  double missNanoseconds = 0;
+  double hitNanoseconds = 0;
+  double hitIdNanoseconds = 0;
+  double fallbackNanoseconds = 0;
+  std::size_t residentBytes = 0;
+  long long peakResidentKilobytes = 0;
+};
+
+/**
+ * @brief The numbers measured for one thread count of the concurrent scenario
+ */
+struct ConcurrencyResult {
+  unsigned int threads = 0;
+  double seconds = 0;
+  long long decodes = 0;
+  bool consistent = true;
+};
+
+/**
+ * @brief The numbers measured for one entry count of the hit latency sweep
+ */
+struct SweepResult {
+  unsigned int entries = 0;
+  double hitNanoseconds = 0;
+  double hitIdNanoseconds = 0;
+};
+
+/**
+ * @brief The numbers measured for scanning the tree
+ */
+struct ScanResult {
+  std::size_t files = 0;
+  double separateSeconds = 0;
+  double singlePassSeconds = 0;
+};
+
+typedef std::chrono::steady_clock Clock;
+
+static double secondsSince(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/**
+ * @brief The peak resident set size of the process so far
+ */
+static long long getPeakResidentKilobytes() {
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS counters;
+  if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    return 0;
+  return static_cast<long long>(counters.PeakWorkingSetSize / 1024);
+#else
+  rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+#ifdef __APPLE__
+  // macOS reports bytes rather than kilobytes
+  return usage.ru_maxrss / 1024;
+#else
+  return usage.ru_maxrss;
+#endif
+#endif
+}
+
+/**
+ * @brief The path of the i-th generated file, spread over options.depth levels of folders
+ */
+static std::string getFilePath(const Options& options, const std::string& type, int i, const std::string& extension) {
+  std::filesystem::path path = std::filesystem::path(options.directory) / type;
+
+  int folder = i;
+  for (int level = 0; level < options.depth; level++) {
+    path /= "d" + std::to_string(folder % options.fanout);
+    folder /= options.fanout;
+  }
+
+  return (path / ("file" + std::to_string(i) + "." + extension)).string();
+}
+
+static bool isLarge(const Options& options, int i) {
+  // Spread the large files evenly rather than putting them all at the start
+  int every = options.largeRatio > 0 ? static_cast<int>(std::lround(1 / options.largeRatio)) : 0;
+  return every > 0 && i % every == 0;
+}
+
+/**
+ * @brief Cheap pseudo random numbers, so that the generated files don't compress to nothing
+ */
+static std::uint32_t nextRandom(std::uint32_t& state) {
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+static bool writeImage(const std::string& path, unsigned int size, std::uint32_t seed) {
+  sf::Image image;
+  image.create(size, size);
+  for (unsigned int y = 0; y < size; y++) {
+    for (unsigned int x = 0; x < size; x++) {
+      std::uint32_t noise = nextRandom(seed);
+      image.setPixel(x, y, sf::Color(x + (noise & 15), y + ((noise >> 4) & 15), noise >> 24));
+    }
+  }
+  return image.saveToFile(path);
+}
+
+static bool writeSound(const std::string& path, double seconds, std::uint32_t seed) {
+  const unsigned int sampleRate = 44100;
+  std::vector<sf::Int16> samples(static_cast<std::size_t>(seconds * sampleRate));
+  for (std::size_t i = 0; i < samples.size(); i++) {
+    double tone = std::sin(i * 440.0 * 6.283185307 / sampleRate) * 8000;
+    samples[i] = static_cast<sf::Int16>(tone + static_cast<int>(nextRandom(seed) % 2000) - 1000);
+  }
+
+  sf::OutputSoundFile file;
+  if (!file.openFromFile(path, sampleRate, 1))
+    return false;
+  file.write(samples.data(), samples.size());
+  return true;
+}
+
+static std::string findSystemFont() {
+  const char* candidates[] = {
+    "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf",
+    "/usr/share/fonts/TTF/DejaVuSans.ttf",
+    "/usr/share/fonts/dejavu/DejaVuSans.ttf",
+    "/System/Library/Fonts/Supplemental/Arial.ttf",
+    "C:/Windows/Fonts/arial.ttf"
+  };
+
+  for (const char* candidate: candidates) {
+    if (std::filesystem::exists(candidate))
+      return candidate;
+  }
+  return "";
+}
+
+/**
+ * @brief Write the tree of assets, unless a kept tree is already there
+ */
+static bool generate(const Options& options) {
+  std::filesystem::path marker = std::filesystem::path(options.directory) / "complete";
+  if (options.keep && std::filesystem::exists(marker))
+    return true;
+
+  std::filesystem::remove_all(options.directory);
+
+  for (int i = 0; i < options.files; i++) {
+    std::string image = getFilePath(options, "textures", i, "png");
+    std::string sound = getFilePath(options, "sounds", i, "wav");
+    std::filesystem::create_directories(std::filesystem::path(image).parent_path());
+    std::filesystem::create_directories(std::filesystem::path(sound).parent_path());
+
+    bool large = isLarge(options, i);
+    if (!writeImage(image, large ? options.largeImage : options.smallImage, i + 1) ||
+        !writeSound(sound, large ? options.largeSound : options.smallSound, i + 1))
+      return false;
+
+    if (!options.font.empty()) {
+      std::string font = getFilePath(options, "fonts", i, "ttf");
+      std::filesystem::create_directories(std::filesystem::path(font).parent_path());
+      std::filesystem::copy_file(options.font, font, std::filesystem::copy_options::overwrite_existing);
+    }
+  }
+
+  // The fallbacks for the miss measurements
+  std::filesystem::path root(options.directory);
+  if (!writeImage((root / "invalid.png").string(), options.smallImage, 1) ||
+      !writeSound((root / "invalid.wav").string(), options.smallSound, 1))
+    return false;
+  if (!options.font.empty())
+    std::filesystem::copy_file(options.font, root / "invalid.ttf", std::filesystem::copy_options::overwrite_existing);
+
+  std::ofstream(marker.string()) << "ok";
+  return true;
+}
+
+/**
+ * @brief Measure preloading, misses, hits and fallbacks for one type of resource
+ */
+template<typename T, typename Loader>
+static Result benchmark(const Options& options, const std::string& type, const std::string& extension) {
+  Result result;
+  result.type = type;
+
+  std::vector<std::string> paths;
+  for (int i = 0; i < options.files; i++) {
+    paths.push_back(getFilePath(options, type, i, extension));
+    result.sourceBytes += std::filesystem::file_size(paths.back());
+  }
+  result.files = static_cast<int>(paths.size());
+
+  std::string folder = (std::filesystem::path(options.directory) / type).string();
+  std::string invalid = (std::filesystem::path(options.directory) / ("invalid." + extension)).string();
+
+  // Preload throughput, with a fresh cache
+  {
+    ResourceCache<T, Loader> cache;
+    cache.setInvalidPath(invalid);
+
+    Clock::time_point start = Clock::now();
+    cache.preLoad(folder, true, options.threads);
+    result.preLoadSeconds = secondsSince(start);
+    result.preLoaded = cache.size();
+  }
+
+  ResourceCache<T, Loader> cache;
+  cache.setInvalidPath(invalid);
+
+  // A miss loads the file on the spot; the files have just been read, so they are in the OS cache
+  Clock::time_point start = Clock::now();
+  for (const std::string& path: paths)
+    cache.get(path);
+  result.missNanoseconds = secondsSince(start) * 1e9 / paths.size();
+  result.residentBytes = cache.getBytes();
+
+  // Hits by path, going through the files in order so that each lookup is for a different key
+  std::size_t checksum = 0;
+  start = Clock::now();
+  for (long long i = 0; i < options.lookups; i++)
+    checksum += reinterpret_cast<std::uintptr_t>(cache.get(paths[i % paths.size()]));
+  result.hitNanoseconds = secondsSince(start) * 1e9 / options.lookups;
+
+  // The same hits by ResourceId, hashed up front as RES_ID would be at compile time
+  std::vector<ResourceId> ids;
+  for (const std::string& path: paths)
+    ids.emplace_back(path);
+
+  start = Clock::now();
+  for (long long i = 0; i < options.lookups; i++)
+    checksum += reinterpret_cast<std::uintptr_t>(cache.get(ids[i % ids.size()]));
+  result.hitIdNanoseconds = secondsSince(start) * 1e9 / options.lookups;
+
+  // Misses for files that don't exist, which fall back to the invalid file
+  const int fallbacks = 100;
+  start = Clock::now();
+  for (int i = 0; i < fallbacks; i++)
+    checksum += reinterpret_cast<std::uintptr_t>(cache.get(folder + "/missing" + std::to_string(i) + "." + extension));
+  result.fallbackNanoseconds = secondsSince(start) * 1e9 / fallbacks;
+
+  // Keeps the lookups from being optimized away
+  if (checksum == 1)
+    std::cerr << checksum << std::endl;
+
+  result.peakResidentKilobytes = getPeakResidentKilobytes();
+  return result;
+}
+
+/**
+ * @brief Time listing the textures, sounds and fonts of the whole tree with a walk for each, and with a single walk
+ */
+static ScanResult benchmarkScan(const Options& options) {
+  ScanResult result;
+
+  // Once first, so that both are measured with the directories in the OS cache
+  ResourceCache<sf::Image, HeadlessTextureLoader>::findFiles(options.directory, true);
+
+  Clock::time_point start = Clock::now();
+  result.files += ResourceCache<sf::Image, HeadlessTextureLoader>::findFiles(options.directory, true).size();
+  result.files += ResourceCache<SoundBufferLoader::Decoded, HeadlessSoundLoader>::findFiles(options.directory, true).size();
+  result.files += ResourceCache<sf::Font, FontLoader>::findFiles(options.directory, true).size();
+  result.separateSeconds = secondsSince(start);
+
+  start = Clock::now();
+  std::vector<std::string> textures, sounds, fonts;
+  scanFiles(options.directory, true, [&](const std::filesystem::path& path) {
+    std::filesystem::path extension = path.extension();
+    if (matchesExtension(extension, TextureLoader::EXTENSIONS))
+      textures.push_back(path.string());
+    else if (matchesExtension(extension, SoundBufferLoader::EXTENSIONS))
+      sounds.push_back(path.string());
+    else if (matchesExtension(extension, FontLoader::EXTENSIONS))
+      fonts.push_back(path.string());
+  });
+  std::sort(textures.begin(), textures.end());
+  std::sort(sounds.begin(), sounds.end());
+  std::sort(fonts.begin(), fonts.end());
+  result.singlePassSeconds = secondsSince(start);
+
+  if (textures.size() + sounds.size() + fonts.size() != result.files)
+    std::cerr << "The single pass scan found a different number of files" << std::endl;
+
+  return result;
+}
+
+/**
+ * @brief Have the given number of threads look up every texture in a new thread safe cache at once,
+ * starting at different files, and check that each file was only decoded once
+ */
+static ConcurrencyResult benchmarkConcurrency(const Options& options, unsigned int threads) {
+  ConcurrencyResult result;
+  result.threads = threads;
+
+  std::vector<std::string> paths;
+  for (int i = 0; i < options.files; i++)
+    paths.push_back(getFilePath(options, "textures", i, "png"));
+
+  ResourceCache<sf::Image, CountingTextureLoader> cache;
+  cache.setInvalidPath((std::filesystem::path(options.directory) / "invalid.png").string());
+  cache.setThreadSafe(true);
+  CountingTextureLoader::decodes = 0;
+
+  // Every thread records what it got for each path on its first pass, to compare afterwards
+  std::vector<std::vector<sf::Image*>> seen(threads, std::vector<sf::Image*>(paths.size()));
+  std::atomic<unsigned int> ready{0};
+  std::atomic<bool> go{false};
+
+  std::vector<std::thread> workers;
+  for (unsigned int t = 0; t < threads; t++) {
+    workers.emplace_back([&, t]() {
+      ready++;
+      while (!go.load())
+        std::this_thread::yield();
+
+      std::size_t offset = paths.size() * t / threads;
+      for (long long i = 0; i < options.lookups; i++) {
+        std::size_t index = (offset + i) % paths.size();
+        sf::Image* image = cache.get(paths[index]);
+        if (i < static_cast<long long>(paths.size()))
+          seen[t][index] = image;
+      }
+    });
+  }
+
+  while (ready.load() < threads)
+    std::this_thread::yield();
+
+  Clock::time_point start = Clock::now();
+  go = true;
+  for (std::thread& worker: workers)
+    worker.join();
+  result.seconds = secondsSince(start);
+
+  result.decodes = CountingTextureLoader::decodes.load();
+  result.consistent = result.decodes == static_cast<long long>(paths.size());
+  for (std::size_t i = 0; i < paths.size(); i++) {
+    for (unsigned int t = 0; t < threads; t++) {
+      if (seen[t][i] != seen[0][i] || seen[t][i] != cache.get(paths[i]))
+        result.consistent = false;
+    }
+  }
+
+  return result;
+}
+
+/**
+ * @brief Time hits by path and by ResourceId on a cache of the given number of synthetic entries
+ */
+static SweepResult benchmarkSweep(const Options& options, unsigned int entries) {
+  SweepResult result;
+  result.entries = entries;
+
+  ResourceCache<int, SyntheticLoader> cache;
+  std::vector<std::string> paths;
+  std::vector<ResourceId> ids;
+  for (unsigned int i = 0; i < entries; i++) {
+    paths.push_back("synthetic/d" + std::to_string(i % 64) + "/file" + std::to_string(i) + ".dat");
+    ids.emplace_back(paths.back());
+    cache.get(paths.back());
+  }
+
+  // The same shuffled order for both, so that they only differ in how the key is hashed
+  std::vector<std::uint32_t> order(entries);
+  std::uint32_t seed = entries;
+  for (unsigned int i = 0; i < entries; i++) {
+    std::uint32_t other = nextRandom(seed) % (i + 1);
+    order[i] = order[other];
+    order[other] = i;
+  }
+
+  std::size_t checksum = 0;
+  Clock::time_point start = Clock::now();
+  for (long long i = 0; i < options.lookups; i++)
+    checksum += *cache.get(paths[order[i % entries]]);
+  result.hitNanoseconds = secondsSince(start) * 1e9 / options.lookups;
+
+  start = Clock::now();
+  for (long long i = 0; i < options.lookups; i++)
+    checksum += *cache.get(ids[order[i % entries]]);
+  result.hitIdNanoseconds = secondsSince(start) * 1e9 / options.lookups;
+
+  // Keeps the lookups from being optimized away
+  if (checksum != static_cast<std::size_t>(options.lookups) * 2)
+    std::cerr << "The synthetic cache returned the wrong values" << std::endl;
+
+  return result;
+}
+
+/**
+ * @brief Pack images of random sizes into an atlas, and check where they ended up
+ *
+ * @return true Every image was placed correctly
+ */
+static bool checkAtlas(const Options& options) {
+  const unsigned int pageSize = 256;
+  const unsigned int padding = 1;
+  TextureAtlas atlas(pageSize, padding);
+
+  struct Packed {
+    std::string path;
+    std::size_t page;
+    sf::IntRect rect;
+    sf::Color color;
+  };
+  std::vector<Packed> packed;
+
+  std::uint32_t seed = 12345;
+  bool ok = true;
+  int rejected = 0;
+  for (int i = 0; i < options.files; i++) {
+    // Mostly small images, with the odd one that is too large to fit on a page at all
+    unsigned int width = 1 + nextRandom(seed) % (i % 50 == 0 ? pageSize * 2 : pageSize / 4);
+    unsigned int height = 1 + nextRandom(seed) % (i % 50 == 0 ? pageSize * 2 : pageSize / 4);
+    bool fits = width + padding <= pageSize && height + padding <= pageSize;
+
+    std::uint32_t noise = nextRandom(seed);
+    sf::Color color(noise & 255, (noise >> 8) & 255, (noise >> 16) & 255, 255);
+    sf::Image image;
+    image.create(width, height, color);
+
+    std::string path = "image" + std::to_string(i) + ".png";
+    if (atlas.add(path, image) != fits) {
+      std::cerr << "Atlas: " << path << " (" << width << "x" << height << ") was "
+                << (fits ? "turned away" : "packed") << std::endl;
+      ok = false;
+    }
+    if (!fits) {
+      rejected++;
+      continue;
+    }
+
+    Packed& entry = packed.emplace_back();
+    entry.path = path;
+    entry.color = color;
+    if (!atlas.getPlacement(path, entry.page, entry.rect) ||
+        entry.rect.width != static_cast<int>(width) || entry.rect.height != static_cast<int>(height)) {
+      std::cerr << "Atlas: " << path << " has no placement of its size" << std::endl;
+      ok = false;
+      packed.pop_back();
+    }
+  }
+
+  for (std::size_t i = 0; i < packed.size(); i++) {
+    const Packed& a = packed[i];
+    const sf::IntRect& rect = a.rect;
+    if (rect.left < 0 || rect.top < 0 || rect.left + rect.width + static_cast<int>(padding) > static_cast<int>(pageSize) ||
+        rect.top + rect.height + static_cast<int>(padding) > static_cast<int>(pageSize)) {
+      std::cerr << "Atlas: " << a.path << " is outside of its page" << std::endl;
+      ok = false;
+      continue;
+    }
+
+    // The padding belongs to the image, so it can't overlap another image either
+    sf::IntRect padded(rect.left, rect.top, rect.width + padding, rect.height + padding);
+    for (std::size_t j = i + 1; j < packed.size(); j++) {
+      const Packed& b = packed[j];
+      sf::IntRect other(b.rect.left, b.rect.top, b.rect.width + padding, b.rect.height + padding);
+      if (a.page == b.page && padded.intersects(other)) {
+        std::cerr << "Atlas: " << a.path << " overlaps " << b.path << std::endl;
+        ok = false;
+      }
+    }
+
+    // Corners only, which is enough to catch a copy to the wrong place
+    const sf::Image& page = atlas.getPageImage(a.page);
+    unsigned int left = rect.left, top = rect.top;
+    unsigned int right = rect.left + rect.width - 1, bottom = rect.top + rect.height - 1;
+    for (sf::Vector2u corner: {sf::Vector2u(left, top), sf::Vector2u(right, top), sf::Vector2u(left, bottom), sf::Vector2u(right, bottom)}) {
+      if (page.getPixel(corner.x, corner.y) != a.color) {
+        std::cerr << "Atlas: " << a.path << " doesn't have its pixels on the page" << std::endl;
+        ok = false;
+        break;
+      }
+    }
+  }
+
+  std::cout << "{\n";
+  std::cout << "  \"atlas_check\": {\n";
+  std::cout << "    \"images\": " << options.files << ",\n";
+  std::cout << "    \"packed\": " << packed.size() << ",\n";
+  std::cout << "    \"rejected\": " << rejected << ",\n";
+  std::cout << "    \"pages\": " << atlas.getNumberOfPages() << ",\n";
+  std::cout << "    \"ok\": " << (ok ? "true" : "false") << "\n";
+  std::cout << "  }\n";
+  std::cout << "}\n";
+  return ok;
+}
+
+static void writeJson(std::ostream& out, const Options& options, const std::vector<Result>& results,
+                      const ScanResult& scan, const std::vector<ConcurrencyResult>& concurrency,
+                      const std::vector<SweepResult>& sweep) {
+  out << "{\n";
+  out << "  \"config\": {\n";
+  out << "    \"files\": " << options.files << ",\n";
+  out << "    \"depth\": " << options.depth << ",\n";
+  out << "    \"fanout\": " << options.fanout << ",\n";
+  out << "    \"small_image\": " << options.smallImage << ",\n";
+  out << "    \"large_image\": " << options.largeImage << ",\n";
+  out << "    \"small_sound_seconds\": " << options.smallSound << ",\n";
+  out << "    \"large_sound_seconds\": " << options.largeSound << ",\n";
+  out << "    \"large_ratio\": " << options.largeRatio << ",\n";
+  out << "    \"threads\": " << options.threads << ",\n";
+  out << "    \"lookups\": " << options.lookups << "\n";
+  out << "  },\n";
+
+  out << "  \"results\": [\n";
+  for (std::size_t i = 0; i < results.size(); i++) {
+    const Result& result = results[i];
+    double megabytes = result.sourceBytes / (1024.0 * 1024.0);
+
+    out << "    {\n";
+    out << "      \"type\": \"" << result.type << "\",\n";
+    out << "      \"files\": " << result.files << ",\n";
+    out << "      \"source_bytes\": " << result.sourceBytes << ",\n";
+    out << "      \"preload\": {\n";
+    out << "        \"files_loaded\": " << result.preLoaded << ",\n";
+    out << "        \"seconds\": " << result.preLoadSeconds << ",\n";
+    out << "        \"files_per_second\": " << (result.preLoadSeconds > 0 ? result.preLoaded / result.preLoadSeconds : 0) << ",\n";
+    out << "        \"mb_per_second\": " << (result.preLoadSeconds > 0 && result.preLoaded > 0 ? megabytes / result.preLoadSeconds : 0) << "\n";
+    out << "      },\n";
+    out << "      \"miss_ns\": " << result.missNanoseconds << ",\n";
+    out << "      \"hit_ns\": " << result.hitNanoseconds << ",\n";
+    out << "      \"hit_id_ns\": " << result.hitIdNanoseconds << ",\n";
+    out << "      \"fallback_ns\": " << result.fallbackNanoseconds << ",\n";
+    out << "      \"resident_bytes\": " << result.residentBytes << ",\n";
+    out << "      \"peak_rss_kb\": " << result.peakResidentKilobytes << "\n";
+    out << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+  }
+  out << "  ],\n";
+
+  out << "  \"scan\": {\n";
+  out << "    \"files\": " << scan.files << ",\n";
+  out << "    \"separate_seconds\": " << scan.separateSeconds << ",\n";
+  out << "    \"single_pass_seconds\": " << scan.singlePassSeconds << "\n";
+  out << "  },\n";
+
+  out << "  \"concurrency\": [\n";
+  for (std::size_t i = 0; i < concurrency.size(); i++) {
+    const ConcurrencyResult& result = concurrency[i];
+    double lookups = static_cast<double>(options.lookups) * result.threads;
+
+    out << "    {\n";
+    out << "      \"threads\": " << result.threads << ",\n";
+    out << "      \"seconds\": " << result.seconds << ",\n";
+    out << "      \"lookups_per_second\": " << (result.seconds > 0 ? lookups / result.seconds : 0) << ",\n";
+    out << "      \"lookups_per_second_per_thread\": " << (result.seconds > 0 ? options.lookups / result.seconds : 0) << ",\n";
+    out << "      \"decodes\": " << result.decodes << ",\n";
+    out << "      \"consistent\": " << (result.consistent ? "true" : "false") << "\n";
+    out << "    }" << (i + 1 < concurrency.size() ? "," : "") << "\n";
+  }
+  out << "  ],\n";
+
+  out << "  \"hit_sweep\": [\n";
+  for (std::size_t i = 0; i < sweep.size(); i++) {
+    out << "    {\n";
+    out << "      \"entries\": " << sweep[i].entries << ",\n";
+    out << "      \"hit_ns\": " << sweep[i].hitNanoseconds << ",\n";
+    out << "      \"hit_id_ns\": " << sweep[i].hitIdNanoseconds << "\n";
+    out << "    }" << (i + 1 < sweep.size() ? "," : "") << "\n";
+  }
+  out << "  ],\n";
+
+  out << "  \"peak_rss_kb\": " << getPeakResidentKilobytes() << "\n";
+  out << "}\n";
+}
+
+/**
+ * @brief Parse a comma separated list of positive numbers, or "none" for an empty list
+ */
+static bool parseList(const std::string& value, std::vector<unsigned int>& list) {
+  list.clear();
+  if (value == "none")
+    return true;
+
+  std::size_t start = 0;
+  while (start <= value.size()) {
+    std::size_t comma = std::min(value.find(',', start), value.size());
+    unsigned long number = std::strtoul(value.substr(start, comma - start).c_str(), nullptr, 10);
+    if (number == 0)
+      return false;
+    list.push_back(number);
+    start = comma + 1;
+  }
+  return true;
+}
+
+static bool parseOption(const std::string& argument, Options& options) {
+  std::size_t equals = argument.find('=');
+  std::string name = argument.substr(0, equals);
+  std::string value = equals == std::string::npos ? "" : argument.substr(equals + 1);
+
+  if (name == "--keep")
+    options.keep = true;
+  else if (name == "--check-atlas")
+    options.checkAtlas = true;
+  else if (value.empty())
+    return false;
+  else if (name == "--files")
+    options.files = std::atoi(value.c_str());
+  else if (name == "--depth")
+    options.depth = std::atoi(value.c_str());
+  else if (name == "--fanout")
+    options.fanout = std::max(1, std::atoi(value.c_str()));
+  else if (name == "--small-image")
+    options.smallImage = std::strtoul(value.c_str(), nullptr, 10);
+  else if (name == "--large-image")
+    options.largeImage = std::strtoul(value.c_str(), nullptr, 10);
+  else if (name == "--small-sound")
+    options.smallSound = std::atof(value.c_str());
+  else if (name == "--large-sound")
+    options.largeSound = std::atof(value.c_str());
+  else if (name == "--large-ratio")
+    options.largeRatio = std::atof(value.c_str());
+  else if (name == "--font")
+    options.font = value;
+  else if (name == "--threads")
+    options.threads = std::strtoul(value.c_str(), nullptr, 10);
+  else if (name == "--lookups")
+    options.lookups = std::atoll(value.c_str());
+  else if (name == "--concurrency")
+    return parseList(value, options.concurrency);
+  else if (name == "--sweep")
+    return parseList(value, options.sweep);
+  else if (name == "--dir")
+    options.directory = value;
+  else if (name == "--output")
+    options.output = value;
+  else
+    return false;
+
+  return true;
+}
+
+int main(int argc, char** argv) {
+  Options options;
+  options.font = findSystemFont();
+
+  for (int i = 1; i < argc; i++) {
+    if (!parseOption(argv[i], options)) {
+      std::cerr << "Unknown option " << argv[i] << " (see the top of ResourceBenchmark.cpp)" << std::endl;
+      return 1;
+    }
+  }
+
+  if (options.files <= 0) {
+    std::cerr << "--files has to be at least 1" << std::endl;
+    return 1;
+  }
+  if (options.threads == 0)
+    options.threads = std::max(1u, std::thread::hardware_concurrency());
+
+  if (options.checkAtlas)
+    return checkAtlas(options) ? 0 : 2;
+
+  if (!generate(options)) {
+    std::cerr << "Failed to generate the assets in " << options.directory << std::endl;
+    return 1;
+  }
+
+  std::vector<Result> results;
+  results.push_back(benchmark<sf::Image, HeadlessTextureLoader>(options, "textures", "png"));
+  results.push_back(benchmark<SoundBufferLoader::Decoded, HeadlessSoundLoader>(options, "sounds", "wav"));
+  if (!options.font.empty())
+    results.push_back(benchmark<sf::Font, FontLoader>(options, "fonts", "ttf"));
+  else
+    std::cerr << "No font found, so fonts are skipped (see --font)" << std::endl;
+
+  ScanResult scan = benchmarkScan(options);
+
+  std::vector<ConcurrencyResult> concurrency;
+  bool consistent = true;
+  for (unsigned int threads: options.concurrency) {
+    concurrency.push_back(benchmarkConcurrency(options, threads));
+    if (!concurrency.back().consistent) {
+      std::cerr << "Concurrent lookups on " << threads << " threads decoded " << concurrency.back().decodes
+                << " times for " << options.files << " files, or returned different resources" << std::endl;
+      consistent = false;
+    }
+  }
+
+  std::vector<SweepResult> sweep;
+  for (unsigned int entries: options.sweep)
+    sweep.push_back(benchmarkSweep(options, entries));
+
+  if (!options.keep)
+    std::filesystem::remove_all(options.directory);
+
+  if (options.output.empty()) {
+    writeJson(std::cout, options, results, scan, concurrency, sweep);
+  } else {
+    std::ofstream file(options.output);
+    writeJson(file, options, results, scan, concurrency, sweep);
+  }
+
+  return consistent ? 0 : 2;
+}